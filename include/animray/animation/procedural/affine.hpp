@@ -23,7 +23,7 @@
 #pragma once
 
 
-#include <animray/matrix.hpp>
+#include <animray/affine-matrix.hpp>
 #include <animray/animation/animate.hpp>
 #include <animray/interpolation/linear.hpp>
 
@@ -85,7 +85,9 @@ namespace animray::animation {
             std::optional<intersection_type> hit(
                     instance.intersects(by * transform.first, epsilon));
             if (hit) {
-                return hit.value() * transform.second;
+                auto world{hit.value()};
+                world.transform_normal(transform.second, transform.first);
+                return world;
             } else {
                 return {};
             }
@@ -104,7 +106,7 @@ namespace animray::animation {
 
     template<typename A, typename B, typename E, typename O>
     affine(A, B, E, std::size_t, O) -> affine<
-            matrix<typename O::local_coord_type>,
+            affine_matrix<typename O::local_coord_type>,
             std::remove_pointer_t<A>,
             O>;
 
@@ -0,0 +1,92 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/mixins/depth-count.hpp>
+
+#include <optional>
+
+
+namespace animray {
+
+
+    /**
+     * ## Path continuation
+     *
+     * Where the light seen along a path comes from once it strikes a
+     * surface that reflects or transmits it. The light coming back along
+     * `ray` is multiplied by `weight`. When there is no `ray` the path has
+     * gone as deep as the surface allows and it sees the background
+     * instead.
+     */
+    template<typename C, typename R>
+    struct continuation {
+        /// The type of ray that carries on the path
+        using ray_type = typename with_depth_count<R>::type;
+
+        /// How much of the light coming back along the ray is passed on
+        C weight;
+        /// The ray that the path carries on along
+        std::optional<ray_type> ray;
+    };
+
+
+    /// Surfaces end the path unless they say otherwise
+    template<typename C, typename RI, typename I, typename G>
+    struct surface_bounce {
+        surface_bounce() = default;
+        std::optional<continuation<C, RI>>
+                operator()(const RI &, const I &, const G &) const {
+            return {};
+        }
+    };
+
+
+    /// The light coming back along a continuation, found by tracing its ray
+    /// through the scene
+    template<typename C, typename R, typename G>
+    C follow(continuation<C, R> const &next, G const &scene) {
+        if (next.ray) {
+            return C(scene(*next.ray)) * next.weight;
+        } else {
+            return C(scene.background) * next.weight;
+        }
+    }
+
+
+    /// Calls in to the relevant surface bounce handler
+    template<typename C, typename RI, typename I, typename G>
+    std::optional<continuation<C, RI>>
+            bounce(const RI &observer, const I &intersection, const G &scene) {
+        return surface_bounce<C, RI, I, G>{}(observer, intersection, scene);
+    }
+
+
+    /// True for surface layers that carry the path on
+    template<typename L, typename C, typename RI, typename I, typename G>
+    concept bouncing_layer = requires(
+            L const &layer, RI const &observer, I const &i, G const &scene) {
+        layer.template bounce<C>(observer, i, scene);
+    };
+
+
+}
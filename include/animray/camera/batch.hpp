@@ -0,0 +1,114 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/affine-matrix.hpp>
+#include <animray/ray.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+namespace animray {
+
+
+    /**
+     * # Ray batch
+     *
+     * The rays for a rectangular tile of a camera's pixels. Each co-ordinate
+     * is kept in its own array (structure of arrays) so that the cameras
+     * can fill them, and anything consuming them can read them, a whole
+     * row of pixels at a time. The rays are in row order, starting at the
+     * top left of the tile, and the directions are of unit length.
+     */
+    template<typename D>
+    struct ray_batch {
+        /// The type of the co-ordinates
+        using local_coord_type = D;
+        /// The type of ray that can be read out of the batch
+        using ray_type = cartesian_ray<D>;
+
+        /// The location of the tile on the film, in pixels
+        std::size_t x{}, y{};
+        /// The size of the tile in pixels
+        std::size_t columns{}, rows{};
+        /// Which of the samples for each pixel the rays are for
+        std::size_t sample{};
+
+        /// The starts of the rays
+        std::vector<D> from_x, from_y, from_z;
+        /// The directions of the rays
+        std::vector<D> direction_x, direction_y, direction_z;
+
+        /// The number of rays in the batch
+        std::size_t size() const { return columns * rows; }
+
+        /// Set the tile the batch is for, making room for its rays
+        void tile(
+                std::size_t const tx,
+                std::size_t const ty,
+                std::size_t const c,
+                std::size_t const r) {
+            x = tx;
+            y = ty;
+            columns = c;
+            rows = r;
+            for (auto *v :
+                 {&from_x, &from_y, &from_z, &direction_x, &direction_y,
+                  &direction_z}) {
+                v->resize(size());
+            }
+        }
+
+        /// Return the ray at the index
+        ray_type operator[](std::size_t const i) const {
+            return {cartesian3d<D>{from_x[i], from_y[i], from_z[i]},
+                    direction3d<D>{
+                            direction_x[i], direction_y[i], direction_z[i]}};
+        }
+
+        /// Normalise the directions
+        void normalise() {
+            for (std::size_t i{}; i != size(); ++i) {
+                D const r = D(1)
+                        / std::sqrt(direction_x[i] * direction_x[i]
+                                    + direction_y[i] * direction_y[i]
+                                    + direction_z[i] * direction_z[i]);
+                direction_x[i] *= r;
+                direction_y[i] *= r;
+                direction_z[i] *= r;
+            }
+        }
+    };
+
+
+    namespace detail {
+        /// A column of the linear part of an affine matrix, which is where
+        /// the matrix sends that axis
+        template<typename D>
+        cartesian3d<D> axis(affine_matrix<D> const &m, std::size_t const c) {
+            return {m[0][c], m[1][c], m[2][c]};
+        }
+    }
+
+
+}
@@ -23,17 +23,19 @@
 
 
 #include <animray/camera/flat.hpp>
-#include <animray/threading/random-generator.hpp>
+#include <animray/threading/sampler.hpp>
 
 
 namespace animray {
 
 
-    /// Camera that introduces random 2D jitter on the sample locations
+    /// Camera that introduces random 2D jitter on the sample locations. By
+    /// default the jitter for the samples of a pixel comes from a low
+    /// discrepancy sequence
     template<
             typename E,
             typename C = flat_camera<E>,
-            typename J = random::jitter<std::uniform_real_distribution<E>>>
+            typename J = random::sampler<E>>
     class flat_jitter_camera {
         /// The camera performing the base mapping
         C inner_camera;
@@ -52,12 +54,35 @@ namespace animray {
                 resolution_type r)
         : inner_camera(w, h, c, r) {}
 
-        /// Map between pixel co-ordinates and world co-ordinates
+        /// Map between pixel co-ordinates and world co-ordinates. The
+        /// jitter is for whichever sample the render loop is at
         auto operator()(resolution_type x, resolution_type y) const {
-            return inner_camera(x, y)
-                    + point2d<extents_type>(
-                            J::sample() * inner_camera.pixel_width(),
-                            J::sample() * inner_camera.pixel_height());
+            extents_type const jx = J::sample() * inner_camera.pixel_width();
+            extents_type const jy = J::sample() * inner_camera.pixel_height();
+            return inner_camera(x, y) + point2d<extents_type>(jx, jy);
+        }
+
+        /// Write the world co-ordinates of a tile of pixels in row order.
+        /// Each pixel gets the same jitter as the numbered sample from
+        /// `operator()` would
+        void positions(
+                resolution_type const x,
+                resolution_type const y,
+                resolution_type const c,
+                resolution_type const r,
+                std::span<extents_type> const xs,
+                std::span<extents_type> const ys,
+                std::size_t const sample = {}) const {
+            inner_camera.positions(x, y, c, r, xs, ys);
+            extents_type const w = inner_camera.pixel_width();
+            extents_type const h = inner_camera.pixel_height();
+            for (resolution_type row{}; row != r; ++row) {
+                for (resolution_type col{}; col != c; ++col) {
+                    random::at_pixel(x + col, y + row, sample);
+                    xs[row * c + col] += J::sample() * w;
+                    ys[row * c + col] += J::sample() * h;
+                }
+            }
         }
     };
 
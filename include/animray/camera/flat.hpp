@@ -25,6 +25,8 @@
 
 #include <animray/point2d.hpp>
 
+#include <span>
+
 
 namespace animray {
 
@@ -58,6 +60,31 @@ namespace animray {
                     -height * ((y + half) / rows - half)};
         }
 
+        /// Write the world co-ordinates of a tile of pixels in row order.
+        /// There is only one divide per axis for the whole tile, after which
+        /// each pixel is a step along from the first. The sample number is
+        /// only needed by cameras that jitter the positions
+        void positions(
+                resolution_type const x,
+                resolution_type const y,
+                resolution_type const c,
+                resolution_type const r,
+                std::span<extents_type> const xs,
+                std::span<extents_type> const ys,
+                std::size_t const = {}) const {
+            extents_type const step_x = width / columns;
+            extents_type const step_y = -height / rows;
+            extents_type const left = step_x * (x + half) - width * half;
+            extents_type const top = step_y * (y + half) + height * half;
+            for (resolution_type row{}; row != r; ++row) {
+                extents_type const py = top + step_y * row;
+                for (resolution_type col{}; col != c; ++col) {
+                    xs[row * c + col] = left + step_x * col;
+                    ys[row * c + col] = py;
+                }
+            }
+        }
+
         /// The width of the camera
         extents_type width;
         /// The height of the camera
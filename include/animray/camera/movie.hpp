@@ -24,7 +24,7 @@
 
 
 #include <animray/mixins/frame.hpp>
-#include <animray/threading/random-generator.hpp>
+#include <animray/threading/sampler.hpp>
 
 
 namespace animray {
@@ -57,10 +57,19 @@ namespace animray {
         /// Allow the instance to be used as a camera
         template<typename S>
         ray_type operator()(S x, S y) const {
+            random::at_frame(frame);
             ray_type ray{frame_camera(x, y)};
             ray.frame = frame;
             return ray;
         }
+
+        /// Fill a batch with the rays for a tile. The frame is the same for
+        /// every ray, so it isn't stored in the batch
+        template<typename B, typename... A>
+        void fill(B &batch, A const &...args) const {
+            random::at_frame(frame);
+            frame_camera.fill(batch, args...);
+        }
     };
 
 
@@ -69,7 +78,7 @@ namespace animray {
             typename C,
             typename F = std::size_t,
             typename T = float,
-            typename J = random::jitter<std::uniform_real_distribution<T>>>
+            typename J = random::sampler<T>>
     class movie {
       public:
         /// The type of the frame camera
@@ -97,6 +106,7 @@ namespace animray {
         /// Allow the instance to be used as a camera
         template<typename S>
         ray_type operator()(S x, S y) const {
+            random::at_frame(frame);
             ray_type ray{frame_camera(x, y)};
             ray.frame(frame + J::sample() * shutter);
             return ray;
@@ -23,6 +23,7 @@
 #pragma once
 
 
+#include <animray/camera/batch.hpp>
 #include <animray/camera/flat.hpp>
 
 
@@ -66,6 +67,40 @@ namespace animray {
                     end_type(pc.x, pc.y, focal_plane + direction));
         }
 
+        /// Fill the batch with the rays for a tile of pixels. The rays are
+        /// transformed by `to_world`, which is applied to the camera's axes
+        /// once rather than to every ray
+        void
+                fill(ray_batch<local_coord_type> &batch,
+                     resolution_type const x,
+                     resolution_type const y,
+                     resolution_type const c,
+                     resolution_type const r,
+                     affine_matrix<local_coord_type> const &to_world =
+                             {}) const {
+            batch.tile(x, y, c, r);
+            camera.positions(
+                    x, y, c, r, batch.from_x, batch.from_y, batch.sample);
+            auto const origin = to_world
+                    * cartesian3d<local_coord_type>{
+                            local_coord_type{}, local_coord_type{},
+                            focal_plane};
+            auto const across = detail::axis(to_world, 0);
+            auto const up = detail::axis(to_world, 1);
+            auto const ahead =
+                    (detail::axis(to_world, 2) * direction).unit();
+            for (std::size_t i{}; i != batch.size(); ++i) {
+                auto const px = batch.from_x[i];
+                auto const py = batch.from_y[i];
+                batch.from_x[i] = origin.x() + across.x() * px + up.x() * py;
+                batch.from_y[i] = origin.y() + across.y() * px + up.y() * py;
+                batch.from_z[i] = origin.z() + across.z() * px + up.z() * py;
+                batch.direction_x[i] = ahead.x();
+                batch.direction_y[i] = ahead.y();
+                batch.direction_z[i] = ahead.z();
+            }
+        }
+
       private:
         /// The location of the focal plane for the camera
         extents_type focal_plane;
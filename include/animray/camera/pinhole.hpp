@@ -23,6 +23,7 @@
 #pragma once
 
 
+#include <animray/camera/batch.hpp>
 #include <animray/camera/flat.hpp>
 
 
@@ -66,6 +67,44 @@ namespace animray {
                     end_type(pc.x, pc.y, focal_plane + focal_length));
         }
 
+        /// Fill the batch with the rays for a tile of pixels. The rays are
+        /// transformed by `to_world`, which is applied to the camera's axes
+        /// once rather than to every ray
+        void
+                fill(ray_batch<local_coord_type> &batch,
+                     resolution_type const x,
+                     resolution_type const y,
+                     resolution_type const c,
+                     resolution_type const r,
+                     affine_matrix<local_coord_type> const &to_world =
+                             {}) const {
+            batch.tile(x, y, c, r);
+            camera.positions(
+                    x, y, c, r, batch.direction_x, batch.direction_y,
+                    batch.sample);
+            auto const from = to_world
+                    * cartesian3d<local_coord_type>{
+                            local_coord_type{}, local_coord_type{},
+                            focal_plane};
+            auto const across = detail::axis(to_world, 0);
+            auto const up = detail::axis(to_world, 1);
+            auto const ahead = detail::axis(to_world, 2) * focal_length;
+            for (std::size_t i{}; i != batch.size(); ++i) {
+                auto const px = batch.direction_x[i];
+                auto const py = batch.direction_y[i];
+                batch.from_x[i] = from.x();
+                batch.from_y[i] = from.y();
+                batch.from_z[i] = from.z();
+                batch.direction_x[i] =
+                        across.x() * px + up.x() * py + ahead.x();
+                batch.direction_y[i] =
+                        across.y() * px + up.y() * py + ahead.y();
+                batch.direction_z[i] =
+                        across.z() * px + up.z() * py + ahead.z();
+            }
+            batch.normalise();
+        }
+
       private:
         /// The location of the focal plane for the camera
         extents_type focal_plane;
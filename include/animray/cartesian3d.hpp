@@ -0,0 +1,222 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/matrix.hpp>
+#include <animray/unit-vector.hpp>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// Divide the first three values by the fourth
+        template<typename D>
+        constexpr std::array<D, 3> cartesian(std::array<D, 4> const &h) {
+            if constexpr (std::is_floating_point_v<D>) {
+                D const r = D(1) / h[3];
+                return {h[0] * r, h[1] * r, h[2] * r};
+            } else {
+                return {h[0] / h[3], h[1] / h[3], h[2] / h[3]};
+            }
+        }
+    }
+
+
+    template<typename D>
+    class direction3d;
+
+
+    /**
+     * # Cartesian co-ordinates
+     *
+     * A location or vector stored as plain `x`, `y` and `z` values. Unlike
+     * `point3d` there is no fourth homogeneous value, so reading the
+     * co-ordinates and doing arithmetic with them never divides. Convert to
+     * `point3d` explicitly where a projective transformation needs it.
+     */
+    template<typename D>
+    class cartesian3d {
+        std::array<D, 3> m_xyz = {};
+
+      public:
+        /// The value type
+        using value_type = D;
+
+        /// The origin
+        constexpr cartesian3d() = default;
+        /// A location from its co-ordinates
+        constexpr cartesian3d(D const x, D const y, D const z)
+        : m_xyz{x, y, z} {}
+        /// Convert from homogeneous co-ordinates
+        explicit constexpr cartesian3d(point3d<D> const &p)
+        : m_xyz{detail::cartesian(p.array())} {}
+        /// The vector along a direction with unit length
+        explicit constexpr cartesian3d(direction3d<D> const &d)
+        : m_xyz{d.x(), d.y(), d.z()} {}
+
+        /// Convert to homogeneous co-ordinates
+        explicit operator point3d<D>() const {
+            return point3d<D>(m_xyz[0], m_xyz[1], m_xyz[2]);
+        }
+
+        /// The co-ordinates
+        constexpr D x() const { return m_xyz[0]; }
+        constexpr D y() const { return m_xyz[1]; }
+        constexpr D z() const { return m_xyz[2]; }
+        constexpr std::array<D, 3> const &array() const { return m_xyz; }
+
+        /// Comparisons
+        constexpr bool operator==(cartesian3d const &) const = default;
+
+        /// Arithmetic
+        constexpr cartesian3d operator+(cartesian3d const &r) const {
+            return {x() + r.x(), y() + r.y(), z() + r.z()};
+        }
+        constexpr cartesian3d operator-(cartesian3d const &r) const {
+            return {x() - r.x(), y() - r.y(), z() - r.z()};
+        }
+        constexpr cartesian3d operator-() const { return {-x(), -y(), -z()}; }
+        constexpr cartesian3d operator*(D const s) const {
+            return {x() * s, y() * s, z() * s};
+        }
+
+        /// The dot product of the location as vector with itself
+        constexpr D dot() const { return x() * x() + y() * y() + z() * z(); }
+        /// The length of the location as vector
+        D magnitude() const { return std::sqrt(dot()); }
+        /// The direction of the location as vector
+        direction3d<D> unit() const { return direction3d<D>{*this}; }
+    };
+
+
+    /**
+     * # Cartesian direction
+     *
+     * A direction stored as a unit length vector. It is normalised once
+     * when it is made, where `unit_vector` keeps its length to one side and
+     * divides by it each time a co-ordinate is read.
+     */
+    template<typename D>
+    class direction3d {
+        std::array<D, 3> m_xyz = {D{}, D{}, D{1}};
+
+      public:
+        /// The value type
+        using value_type = D;
+
+        /// Points along the z axis
+        constexpr direction3d() = default;
+        /// A direction from values that are already normalised
+        constexpr direction3d(D const x, D const y, D const z)
+        : m_xyz{x, y, z} {}
+        /// The direction of a vector
+        explicit direction3d(cartesian3d<D> const &v) {
+            if constexpr (std::is_floating_point_v<D>) {
+                D const r = D(1) / v.magnitude();
+                m_xyz = {v.x() * r, v.y() * r, v.z() * r};
+            } else {
+                D const m = v.magnitude();
+                m_xyz = {v.x() / m, v.y() / m, v.z() / m};
+            }
+        }
+        /// Convert from a unit vector
+        explicit direction3d(unit_vector<D> const &u)
+        : m_xyz{detail::cartesian(point3d<D>{u}.array())} {}
+
+        /// Convert to a unit vector
+        explicit operator unit_vector<D>() const {
+            return unit_vector<D>(m_xyz[0], m_xyz[1], m_xyz[2]);
+        }
+
+        /// The co-ordinates
+        constexpr D x() const { return m_xyz[0]; }
+        constexpr D y() const { return m_xyz[1]; }
+        constexpr D z() const { return m_xyz[2]; }
+        constexpr std::array<D, 3> const &array() const { return m_xyz; }
+
+        /// Comparisons
+        constexpr bool operator==(direction3d const &) const = default;
+
+        /// The opposite direction
+        constexpr direction3d operator-() const { return {-x(), -y(), -z()}; }
+        /// A vector along the direction
+        constexpr cartesian3d<D> operator*(D const s) const {
+            return {x() * s, y() * s, z() * s};
+        }
+    };
+
+
+    template<typename V>
+    cartesian3d(V, V, V) -> cartesian3d<V>;
+
+
+    /// Convert the ends and directions of rays to Cartesian form. Values
+    /// that are already Cartesian are passed through
+    template<typename D>
+    constexpr cartesian3d<D> const &cartesian(cartesian3d<D> const &c) {
+        return c;
+    }
+    template<typename D>
+    cartesian3d<D> cartesian(point3d<D> const &p) {
+        return cartesian3d<D>{p};
+    }
+    template<typename D>
+    constexpr direction3d<D> const &cartesian(direction3d<D> const &d) {
+        return d;
+    }
+    template<typename D>
+    direction3d<D> cartesian(unit_vector<D> const &u) {
+        return direction3d<D>{u};
+    }
+
+
+    /// Transform by a matrix. Only a projective matrix needs a divide
+    template<typename D>
+    cartesian3d<D>
+            operator*(matrix<D> const &m, cartesian3d<D> const &c) {
+        std::array<D, 4> h;
+        for (std::size_t r{}; r != 4; ++r) {
+            h[r] = m[r][0] * c.x() + m[r][1] * c.y() + m[r][2] * c.z()
+                    + m[r][3];
+        }
+        if (h[3] == D(1)) {
+            return {h[0], h[1], h[2]};
+        } else {
+            auto const p = detail::cartesian(h);
+            return {p[0], p[1], p[2]};
+        }
+    }
+
+
+    /// Output to a stream
+    template<typename D>
+    std::ostream &operator<<(std::ostream &o, cartesian3d<D> const &c) {
+        return o << '(' << c.x() << ", " << c.y() << ", " << c.z() << ')';
+    }
+    template<typename D>
+    std::ostream &operator<<(std::ostream &o, direction3d<D> const &d) {
+        return o << '(' << d.x() << ", " << d.y() << ", " << d.z() << ')';
+    }
+
+
+}
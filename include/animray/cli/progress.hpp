@@ -23,6 +23,7 @@
 
 #include <animray/cli/main.hpp>
 #include <animray/formats/targa.hpp>
+#include <animray/threading/random-generator.hpp>
 #include <animray/threading/sub-panel.hpp>
 #include <iostream>
 
@@ -30,19 +31,27 @@
 namespace animray {
 
 
-    template<typename film_type, typename P>
+    /// Render a frame and save it once `encode` has turned it into a film
+    /// that can be saved. The counter based random numbers are set to the
+    /// first sample of each pixel before `pixels` is called for it
+    template<typename film_type, typename P, typename T>
     inline film_type cli_render_frame(
             cli::arguments const &args,
             std::optional<std::size_t> const frame,
             std::size_t const threads,
-            P const pixels) {
+            P const pixels,
+            T const encode) {
         threading::sub_panel_progress progress{args.width, args.height};
         std::promise<film_type> promise;
         auto result = promise.get_future();
         std::thread{[threads, &args, &pixels, &progress,
                      promise = std::move(promise)]() mutable {
             promise.set_value(animray::threading::sub_panel<film_type>(
-                    progress, threads, args.width, args.height, pixels));
+                    progress, threads, args.width, args.height,
+                    [&pixels](auto const x, auto const y) {
+                        random::at_pixel(x, y);
+                        return pixels(x, y);
+                    }));
         }}.detach();
         auto filename = args.output_filename;
         if (frame) {
@@ -61,11 +70,23 @@ namespace animray {
         print();
         std::cout << '\n';
         auto rendered = result.get();
-        animray::targa(filename, rendered);
+        animray::targa(filename, encode(rendered));
         return rendered;
     }
 
 
+    template<typename film_type, typename P>
+    inline film_type cli_render_frame(
+            cli::arguments const &args,
+            std::optional<std::size_t> const frame,
+            std::size_t const threads,
+            P const pixels) {
+        return cli_render_frame<film_type>(
+                args, frame, threads, pixels,
+                [](film_type const &f) -> film_type const & { return f; });
+    }
+
+
     template<typename film_type, typename P>
     inline film_type cli_render(
             cli::arguments const &args, std::size_t const threads, P pixels) {
@@ -0,0 +1,40 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+namespace animray {
+
+
+    /// A single value for how bright a colour is, the mean of its channels.
+    /// Anything without channels is taken to be its own brightness
+    template<typename C>
+    double brightness(C const &c) {
+        if constexpr (requires { c.red(); }) {
+            return (double(c.red()) + double(c.green()) + double(c.blue()))
+                    / 3;
+        } else {
+            return double(c);
+        }
+    }
+
+
+}
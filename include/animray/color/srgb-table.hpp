@@ -0,0 +1,130 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/color/srgb.hpp>
+#include <animray/film.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+
+namespace animray {
+
+
+    /// An 8 by 8 Bayer matrix for ordered dithering, by row
+    inline constexpr std::array<std::uint8_t, 64> bayer_8x8{
+            0,  32, 8,  40, 2,  34, 10, 42, 48, 16, 56, 24, 50, 18, 58, 26,
+            12, 44, 4,  36, 14, 46, 6,  38, 60, 28, 52, 20, 62, 30, 54, 22,
+            3,  35, 11, 43, 1,  33, 9,  41, 51, 19, 59, 27, 49, 17, 57, 25,
+            15, 47, 7,  39, 13, 45, 5,  37, 63, 31, 55, 23, 61, 29, 53, 21};
+
+
+    /**
+     * ## sRGB encoding table
+     *
+     * Converts light within an exposure `limit` to 8 bit sRGB without a
+     * call to `std::pow` for every channel. The levels from
+     * `srgb_channel_level` are stored at `size` evenly spaced points and
+     * interpolated between. With the default size this is within a
+     * hundredth of a level of the curve, apart from the one step that
+     * spans the join between its linear and power parts.
+     *
+     * Given a pixel position the level is offset by an ordered dither
+     * before it is truncated, so that smooth gradients don't band.
+     */
+    template<typename D>
+    class srgb_table {
+        D m_scale;
+        std::vector<D> m_levels;
+
+      public:
+        explicit srgb_table(D const limit = D{1}, std::size_t const size = 4096)
+        : m_scale{D(size) / limit}, m_levels(size + 2) {
+            if (size == 0) {
+                throw std::invalid_argument{
+                        "An sRGB table needs at least one step"};
+            }
+            for (std::size_t i{}; i <= size; ++i) {
+                m_levels[i] = srgb_channel_level(D(i) / D(size), D{1});
+            }
+            /// So that the very top can be interpolated
+            m_levels[size + 1] = m_levels[size];
+        }
+
+        /// The level for a channel, before it is truncated
+        D level(D const value) const {
+            D const at = std::min(
+                    std::max(D{}, value * m_scale), D(m_levels.size() - 2));
+            auto const i = std::size_t(at);
+            return m_levels[i] + (m_levels[i + 1] - m_levels[i]) * (at - i);
+        }
+
+        /// Convert a single channel
+        std::uint8_t operator()(D const value) const { return level(value); }
+        /// Convert a single channel for the pixel at `x`, `y` with dithering
+        std::uint8_t operator()(
+                D const value, std::size_t const x, std::size_t const y) const {
+            D const offset =
+                    (bayer_8x8[(y % 8) * 8 + x % 8] + D{0.5}) / D{64};
+            return std::min(level(value) + offset, D{255});
+        }
+
+        /// Convert a colour
+        rgb<std::uint8_t> operator()(rgb<D> const &c) const {
+            return {(*this)(c.red()), (*this)(c.green()), (*this)(c.blue())};
+        }
+        /// Convert the colour of the pixel at `x`, `y` with dithering
+        rgb<std::uint8_t> operator()(
+                rgb<D> const &c,
+                std::size_t const x,
+                std::size_t const y) const {
+            return {(*this)(c.red(), x, y), (*this)(c.green(), x, y),
+                    (*this)(c.blue(), x, y)};
+        }
+    };
+
+
+    /// Convert a whole film of light to 8 bit sRGB once it has been
+    /// rendered, optionally dithering it
+    template<typename D, typename E>
+    film<rgb<std::uint8_t>, E> to_srgb(
+            film<rgb<D>, E> const &image,
+            srgb_table<D> const &table,
+            bool const dither = false) {
+        using size_type = typename film<rgb<D>, E>::size_type;
+        film<rgb<std::uint8_t>, E> encoded{image.width(), image.height()};
+        for (size_type x{}; x < image.width(); ++x) {
+            auto const &from = image[x];
+            auto &into = encoded[x];
+            for (size_type y{}; y < from.size(); ++y) {
+                into[y] = dither ? table(from[y], x, y) : table(from[y]);
+            }
+        }
+        return encoded;
+    }
+
+
+}
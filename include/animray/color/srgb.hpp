@@ -23,14 +23,17 @@
 
 #include <animray/color/rgb.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 
 namespace animray {
 
 
-    /// Convert a single RGB channel to 8 bit sRGB gamma
+    /// The 8 bit sRGB level for a single RGB channel, before it is truncated
+    /// to a whole number
     template<typename D>
-    inline constexpr std::uint8_t
-            apply_srgb_channel_gamma(D const value, D const limit) {
+    inline constexpr D srgb_channel_level(D const value, D const limit) {
         auto const clamped = std::clamp(value / limit, D{}, D{1});
         if (clamped < D{0.0031308}) {
             return D{255} * (clamped * D{12.92});
@@ -40,6 +43,13 @@ namespace animray {
         }
     }
 
+    /// Convert a single RGB channel to 8 bit sRGB gamma
+    template<typename D>
+    inline constexpr std::uint8_t
+            apply_srgb_channel_gamma(D const value, D const limit) {
+        return srgb_channel_level(value, limit);
+    }
+
     /// Convert a single channel from sRGB gamma to linear. Channel level must
     /// be between 0 and 1
     template<typename D>
@@ -23,9 +23,11 @@
 #pragma once
 
 
+#include <animray/bounce.hpp>
 #include <animray/emission.hpp>
 #include <animray/functional/fold.hpp>
 #include <animray/intersection.hpp>
+#include <animray/occluder.hpp>
 #include <animray/shader.hpp>
 
 #include <optional>
@@ -146,6 +148,47 @@ namespace animray {
                     instances);
             return false;
         }
+
+        /// The number of the geometry that occludes the ray, if any. See
+        /// `occluder_of`
+        template<typename R>
+        std::optional<std::size_t>
+                occluder(const R &by, const local_coord_type epsilon) const {
+            constexpr std::size_t parts = 1 + sizeof...(Os);
+            std::optional<std::size_t> found;
+            std::size_t index{};
+            auto const check = [&](auto const &geom) {
+                if (auto const part = occluder_of(geom, by, epsilon)) {
+                    found = index + parts * *part;
+                    return true;
+                } else {
+                    ++index;
+                    return false;
+                }
+            };
+            std::apply(
+                    [&](const auto &...geom) { (check(geom) || ...); },
+                    instances);
+            return found;
+        }
+        /// Check only the geometry with the occluder number `at`
+        template<typename R>
+        bool occludes(
+                const R &by,
+                const local_coord_type epsilon,
+                std::size_t const at) const {
+            constexpr std::size_t parts = 1 + sizeof...(Os);
+            std::size_t index{};
+            return std::apply(
+                    [&](const auto &...geom) {
+                        return (
+                                (index++ == at % parts
+                                 and occludes_at(
+                                         geom, by, epsilon, at / parts))
+                                || ...);
+                    },
+                    instances);
+        }
     };
 
 
@@ -174,6 +217,22 @@ namespace animray {
     };
 
 
+    /// Compound geometry is lit if any of its parts are
+    template<typename O, typename... Os>
+    struct surface_is_lit<intersection<compound<O, Os...>>> {
+        static bool const value =
+                (surface_is_lit<typename O::intersection_type>::value or ...
+                 or surface_is_lit<typename Os::intersection_type>::value);
+    };
+    /// Whether the part that was struck is lit
+    template<typename O, typename... Os>
+    bool is_lit(intersection<compound<O, Os...>> const &intersection) {
+        return std::visit(
+                [](auto const &inter) { return is_lit(inter); },
+                intersection.wrapped_intersection);
+    }
+
+
     /**
      * Returns the emission characteristics for the light that was
      * struck by the intersection.
@@ -194,6 +253,23 @@ namespace animray {
     };
 
 
+    /// Carry the path on from whichever geometry was struck
+    template<typename C, typename O, typename RI, typename G, typename... Os>
+    struct surface_bounce<C, RI, intersection<compound<O, Os...>>, G> {
+        surface_bounce() = default;
+        std::optional<continuation<C, RI>> operator()(
+                const RI &observer,
+                const intersection<compound<O, Os...>> &intersection,
+                const G &geometry) const {
+            return std::visit(
+                    [&](const auto &inter) {
+                        return bounce<C>(observer, inter, geometry);
+                    },
+                    intersection.wrapped_intersection);
+        }
+    };
+
+
 }
 
 
@@ -23,6 +23,9 @@
 #pragma once
 
 
+#include <limits>
+
+
 namespace animray {
 
     /**
@@ -43,6 +46,26 @@ namespace animray {
     constexpr inline long double epsilon<long double> = 1e-15L;
 
 
+    /**
+     * ## Rounding error bounds
+     *
+     * `unit_roundoff<T>` is the largest relative error from rounding the
+     * result of one floating point operation. `rounding_bound<T>(n)`
+     * bounds the relative error after `n` operations, each of which rounds
+     * (this is the γₙ of the error analysis literature). Both are zero for
+     * types that don't round.
+     */
+    template<typename T>
+    constexpr inline T unit_roundoff = std::numeric_limits<T>::is_exact
+            ? T{}
+            : std::numeric_limits<T>::epsilon() / T{2};
+
+    template<typename T>
+    constexpr T rounding_bound(int const n) {
+        return n * unit_roundoff<T> / (T{1} - n * unit_roundoff<T>);
+    }
+
+
 }
 
 
@@ -0,0 +1,140 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+#include <ostream>
+
+
+namespace animray {
+
+
+    /// An axis aligned box in 3D space. The default constructed box is
+    /// empty and any point added to it will become the whole extents.
+    template<typename D>
+    struct extents3d {
+        /// The type of the co-ordinate values
+        using value_type = D;
+        /// The corner type
+        using corner_type = std::array<value_type, 3>;
+
+        /// The corner with the smallest co-ordinates
+        corner_type lower = {
+                std::numeric_limits<value_type>::max(),
+                std::numeric_limits<value_type>::max(),
+                std::numeric_limits<value_type>::max()};
+        /// The corner with the largest co-ordinates
+        corner_type upper = {
+                std::numeric_limits<value_type>::lowest(),
+                std::numeric_limits<value_type>::lowest(),
+                std::numeric_limits<value_type>::lowest()};
+
+        /// Check for equality
+        bool operator==(extents3d const &) const = default;
+
+        /// True if nothing has been added to the extents
+        bool empty() const {
+            return lower[0] > upper[0] or lower[1] > upper[1]
+                    or lower[2] > upper[2];
+        }
+
+        /// Grow the extents so they include the point
+        extents3d &extend(corner_type const &p) {
+            for (std::size_t a{}; a != 3; ++a) {
+                lower[a] = std::min(lower[a], p[a]);
+                upper[a] = std::max(upper[a], p[a]);
+            }
+            return *this;
+        }
+        /// Grow the extents so they include the other extents
+        extents3d &extend(extents3d const &e) {
+            for (std::size_t a{}; a != 3; ++a) {
+                lower[a] = std::min(lower[a], e.lower[a]);
+                upper[a] = std::max(upper[a], e.upper[a]);
+            }
+            return *this;
+        }
+
+        /// The centre of the box
+        corner_type centre() const {
+            return {(lower[0] + upper[0]) / value_type{2},
+                    (lower[1] + upper[1]) / value_type{2},
+                    (lower[2] + upper[2]) / value_type{2}};
+        }
+
+        /// The axis along which the box is longest
+        std::size_t longest_axis() const {
+            auto const x = upper[0] - lower[0], y = upper[1] - lower[1],
+                       z = upper[2] - lower[2];
+            if (x >= y and x >= z) {
+                return 0;
+            } else if (y >= z) {
+                return 1;
+            } else {
+                return 2;
+            }
+        }
+
+        /// The surface area of the box
+        value_type area() const {
+            if (empty()) { return value_type{}; }
+            auto const x = upper[0] - lower[0], y = upper[1] - lower[1],
+                       z = upper[2] - lower[2];
+            return value_type{2} * (x * y + y * z + z * x);
+        }
+
+        /// Slab test for a ray with the origin `from` and the component wise
+        /// reciprocal of its direction. Returns the distance along the ray
+        /// at which it enters the box if that happens before `limit`.
+        std::optional<value_type>
+                entry(corner_type const &from,
+                      corner_type const &inverse,
+                      value_type const limit) const {
+            value_type near{}, far{limit};
+            for (std::size_t a{}; a != 3; ++a) {
+                value_type t0 = (lower[a] - from[a]) * inverse[a];
+                value_type t1 = (upper[a] - from[a]) * inverse[a];
+                if (t0 > t1) { std::swap(t0, t1); }
+                // Written so that a `NaN` from `0 * inf` never narrows the
+                // range
+                near = t0 > near ? t0 : near;
+                far = t1 < far ? t1 : far;
+                if (near > far) { return {}; }
+            }
+            return near;
+        }
+    };
+
+
+    /// Output an extents to a stream
+    template<typename D>
+    inline std::ostream &operator<<(std::ostream &o, extents3d<D> const &e) {
+        return o << "[ (" << e.lower[0] << ", " << e.lower[1] << ", "
+                 << e.lower[2] << ") -> (" << e.upper[0] << ", " << e.upper[1]
+                 << ", " << e.upper[2] << ") ]";
+    }
+
+
+}
@@ -0,0 +1,275 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/formats/mesh-cache.hpp>
+
+#include <memory>
+
+
+namespace animray {
+
+
+    /**
+     * ## Brick file
+     *
+     * A large mesh cut into spatially coherent bricks, each of which is a
+     * complete mesh cache (see `mesh-cache.hpp`) with its own spatial
+     * index. A directory at the end of the file gives the bounds of each
+     * brick and where it is so that bricks can be read one at a time.
+     *
+     * The header is made up of 64 bit little endian values:
+     *
+     * | Field | Meaning |
+     * |---|---|
+     * | magic | The eight characters `AnimRayB` |
+     * | version | The format version, currently 1 |
+     * | value size | Size in bytes of each co-ordinate value |
+     * | bricks | The number of bricks |
+     * | directory | The position of the directory |
+     *
+     * Each directory entry is the brick's position and size in bytes as 64
+     * bit values followed by the lower and upper corners of its bounds as
+     * co-ordinate values, all little endian.
+     */
+    struct brick_file_header {
+        static constexpr std::array<char, 8> expected_magic{
+                'A', 'n', 'i', 'm', 'R', 'a', 'y', 'B'};
+        static constexpr std::uint64_t current_version = 1;
+        /// The number of bytes that the header takes in the file
+        static constexpr std::size_t bytes = 8 + 4 * 8;
+    };
+
+
+    /// Cut the mesh into bricks of at most `faces_per_brick` triangles by
+    /// following its spatial index and write them to a brick file
+    template<typename M>
+    void save_bricks(
+            std::filesystem::path const &filename,
+            M const &mesh,
+            std::size_t const faces_per_brick) {
+        using value_type = typename M::local_coord_type;
+        using index_type = typename M::index_type;
+        auto const nodes = mesh.nodes();
+
+        // Work out the range of faces below each node and cut the index
+        // into subtrees that are small enough
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        auto const range = [&](auto const &self, std::size_t const n)
+                -> std::pair<std::size_t, std::size_t> {
+            if (nodes[n].leaf()) {
+                return {nodes[n].offset, nodes[n].offset + nodes[n].count};
+            } else {
+                auto const first = self(self, n + 1);
+                auto const second = self(self, nodes[n].offset);
+                return {std::min(first.first, second.first),
+                        std::max(first.second, second.second)};
+            }
+        };
+        auto const cut = [&](auto const &self, std::size_t const n) -> void {
+            auto const r = range(range, n);
+            if (nodes[n].leaf() or r.second - r.first <= faces_per_brick) {
+                ranges.push_back(r);
+            } else {
+                self(self, n + 1);
+                self(self, nodes[n].offset);
+            }
+        };
+        if (nodes.size()) { cut(cut, 0); }
+
+        std::ofstream file{filename, std::ios::binary};
+        auto const put = [&](auto const value) {
+            auto const le = detail::little_endian(value);
+            file.write(reinterpret_cast<char const *>(&le), sizeof(le));
+        };
+        file.write(
+                brick_file_header::expected_magic.data(),
+                brick_file_header::expected_magic.size());
+        put(brick_file_header::current_version);
+        put(std::uint64_t(sizeof(value_type)));
+        put(std::uint64_t(ranges.size()));
+        put(std::uint64_t{}); // The directory position is filled in later
+        std::uint64_t written = brick_file_header::bytes;
+
+        struct entry {
+            std::uint64_t offset, size;
+            extents3d<value_type> bounds;
+        };
+        std::vector<entry> directory;
+        constexpr auto none = std::numeric_limits<index_type>::max();
+        std::vector<index_type> remap(mesh.vertices().size(), none);
+        for (auto const &[first, last] : ranges) {
+            std::vector<typename M::vertex_type> vertices;
+            std::vector<typename M::normal_type> normals;
+            std::vector<typename M::face_type> faces;
+            faces.reserve(last - first);
+            for (auto f = first; f != last; ++f) {
+                auto &face = faces.emplace_back();
+                for (std::size_t c{}; c != 3; ++c) {
+                    auto const v = mesh.faces()[f][c];
+                    if (remap[v] == none) {
+                        remap[v] = index_type(vertices.size());
+                        vertices.push_back(mesh.vertex(v));
+                        if (mesh.normals().size()) {
+                            normals.push_back(mesh.normal(v));
+                        }
+                    }
+                    face[c] = remap[v];
+                }
+            }
+            for (auto f = first; f != last; ++f) {
+                for (auto const v : mesh.faces()[f]) { remap[v] = none; }
+            }
+            M const brick{
+                    std::move(vertices), std::move(faces), std::move(normals)};
+            auto const offset = mesh_cache_header::aligned(written);
+            for (; written < offset; ++written) { file.put(0); }
+            auto const size = write_mesh_cache(file, brick);
+            written += size;
+            directory.push_back({offset, size, brick.bounds()});
+        }
+
+        auto const position = written;
+        for (auto const &e : directory) {
+            put(e.offset);
+            put(e.size);
+            for (auto const v : e.bounds.lower) { put(v); }
+            for (auto const v : e.bounds.upper) { put(v); }
+        }
+        file.seekp(brick_file_header::bytes - 8);
+        put(position);
+        if (not file) {
+            throw std::runtime_error{"Brick file could not be written"};
+        }
+    }
+
+
+    /// Random access to the bricks in a brick file
+    template<typename D>
+    class brick_file {
+        int m_fd;
+
+      public:
+        /// The co-ordinate type of the bricks
+        using value_type = D;
+        /// Where to find each brick
+        struct brick {
+            std::uint64_t offset, size;
+            extents3d<value_type> bounds;
+        };
+
+        /// Open the file and read its directory
+        explicit brick_file(std::filesystem::path const &filename)
+        : m_fd{::open(filename.c_str(), O_RDONLY)} {
+            if (m_fd < 0) {
+                throw std::system_error{
+                        errno, std::generic_category(),
+                        "Opening " + filename.string()};
+            }
+            try {
+                std::array<std::byte, brick_file_header::bytes> header;
+                read(header, 0);
+                if (std::memcmp(
+                            header.data(),
+                            brick_file_header::expected_magic.data(),
+                            brick_file_header::expected_magic.size())) {
+                    throw std::runtime_error{"This is not a brick file"};
+                }
+                auto const field = [&](std::size_t const f) {
+                    return detail::mesh_cache_field(header.data(), f);
+                };
+                if (field(0) != brick_file_header::current_version) {
+                    throw std::runtime_error{"Unsupported brick file version"};
+                } else if (field(1) != sizeof(value_type)) {
+                    throw std::runtime_error{
+                            "Brick file was written for a different value "
+                            "type"};
+                }
+                std::size_t const entry = 2 * 8 + 6 * sizeof(value_type);
+                std::vector<std::byte> directory(field(2) * entry);
+                read(directory, field(3));
+                m_bricks.resize(field(2));
+                for (std::size_t b{}; b != m_bricks.size(); ++b) {
+                    auto p = directory.data() + b * entry;
+                    auto const next = [&p](auto &value) {
+                        std::memcpy(&value, p, sizeof(value));
+                        value = detail::little_endian(value);
+                        p += sizeof(value);
+                    };
+                    next(m_bricks[b].offset);
+                    next(m_bricks[b].size);
+                    for (auto &v : m_bricks[b].bounds.lower) { next(v); }
+                    for (auto &v : m_bricks[b].bounds.upper) { next(v); }
+                }
+            } catch (...) {
+                ::close(m_fd);
+                throw;
+            }
+        }
+        brick_file(brick_file const &) = delete;
+        brick_file &operator=(brick_file const &) = delete;
+        ~brick_file() { ::close(m_fd); }
+
+        /// The bricks in the file
+        std::span<brick const> bricks() const { return m_bricks; }
+
+        /// Read the bytes of a brick into memory
+        std::shared_ptr<std::vector<std::byte>>
+                load(std::size_t const b) const {
+            auto bytes = std::make_shared<std::vector<std::byte>>(
+                    m_bricks.at(b).size);
+            read(*bytes, m_bricks[b].offset);
+            return bytes;
+        }
+
+        /// Read a brick and make a mesh from it
+        template<typename M>
+        M mesh(std::size_t const b) const {
+            auto bytes = load(b);
+            std::span<std::byte const> const blob{*bytes};
+            return view_mesh_cache<M>(blob, std::move(bytes));
+        }
+
+      private:
+        std::vector<brick> m_bricks;
+
+        void read(std::span<std::byte> into, std::uint64_t offset) const {
+            while (into.size()) {
+                auto const got =
+                        ::pread(m_fd, into.data(), into.size(), off_t(offset));
+                if (got < 0 and errno == EINTR) {
+                    continue;
+                } else if (got < 0) {
+                    throw std::system_error{
+                            errno, std::generic_category(),
+                            "Reading brick file"};
+                } else if (got == 0) {
+                    throw std::runtime_error{"The brick file is truncated"};
+                }
+                into = into.subspan(std::size_t(got));
+                offset += std::uint64_t(got);
+            }
+        }
+    };
+
+
+}
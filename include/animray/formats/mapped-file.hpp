@@ -0,0 +1,109 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace animray {
+
+
+    /// A read only memory mapping of a whole file. The file contents are
+    /// paged in by the operating system as they're used, so nothing is
+    /// copied in order to read it.
+    class mapped_file {
+        std::byte const *m_base = nullptr;
+        std::size_t m_size = {};
+
+      public:
+        /// Map the named file
+        explicit mapped_file(std::filesystem::path const &filename) {
+            int const fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::system_error{
+                        errno, std::generic_category(),
+                        "Opening " + filename.string()};
+            }
+            struct ::stat info;
+            if (::fstat(fd, &info) != 0) {
+                auto const error = errno;
+                ::close(fd);
+                throw std::system_error{
+                        error, std::generic_category(),
+                        "Reading the size of " + filename.string()};
+            }
+            m_size = std::size_t(info.st_size);
+            if (m_size) {
+                void *const base =
+                        ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (base == MAP_FAILED) {
+                    auto const error = errno;
+                    ::close(fd);
+                    throw std::system_error{
+                            error, std::generic_category(),
+                            "Mapping " + filename.string()};
+                }
+                m_base = static_cast<std::byte const *>(base);
+                // Only a hint, so failure doesn't matter
+                ::madvise(base, m_size, MADV_WILLNEED);
+            }
+            ::close(fd);
+        }
+        mapped_file(mapped_file const &) = delete;
+        mapped_file(mapped_file &&m)
+        : m_base{std::exchange(m.m_base, nullptr)},
+          m_size{std::exchange(m.m_size, 0)} {}
+        mapped_file &operator=(mapped_file const &) = delete;
+        mapped_file &operator=(mapped_file &&m) {
+            std::swap(m_base, m.m_base);
+            std::swap(m_size, m.m_size);
+            return *this;
+        }
+        ~mapped_file() {
+            if (m_base) {
+                ::munmap(const_cast<std::byte *>(m_base), m_size);
+            }
+        }
+
+        /// The file contents
+        std::span<std::byte const> bytes() const { return {m_base, m_size}; }
+        /// The file contents as text
+        std::string_view text() const {
+            return {reinterpret_cast<char const *>(m_base), m_size};
+        }
+        /// The size of the file in bytes
+        std::size_t size() const { return m_size; }
+    };
+
+
+}
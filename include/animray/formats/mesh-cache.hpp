@@ -0,0 +1,360 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/formats/mapped-file.hpp>
+#include <animray/geometry/mesh.hpp>
+#include <felspar/exceptions/overflow_error.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+
+namespace animray {
+
+
+    /**
+     * ## Mesh cache
+     *
+     * A binary file holding a mesh's buffers, including its spatial index,
+     * exactly as the mesh uses them. All values are little endian. On little
+     * endian machines a mapping of the file is used directly by the mesh so
+     * loading doesn't need to read or copy anything.
+     *
+     * The file starts with a header of 64 bit little endian values:
+     *
+     * | Field | Meaning |
+     * |---|---|
+     * | magic | The eight characters `AnimRayM` |
+     * | version | The format version, currently 2 |
+     * | value size | Size in bytes of each co-ordinate value |
+     * | node size | Size in bytes of each spatial index node |
+     * | counts | Vertices, faces, normals then nodes |
+     * | offsets | Where each of the four buffers starts |
+     * | size | The total size of the cached mesh |
+     * | encodings | How positions and then normals are stored |
+     *
+     * Version 1 files have no encodings and store both exactly. From
+     * version 2 the header is followed by the lower and upper corners of
+     * the range used by the position encoding as co-ordinate values.
+     *
+     * Each buffer starts on a multiple of 64 bytes from the start of the
+     * header. Offsets are from the start of the header, so a cached mesh can
+     * be embedded part way through a larger file as long as it starts on a
+     * 64 byte boundary.
+     */
+    struct mesh_cache_header {
+        static constexpr std::array<char, 8> expected_magic{
+                'A', 'n', 'i', 'm', 'R', 'a', 'y', 'M'};
+        static constexpr std::uint64_t current_version = 2;
+        /// The alignment of the buffers
+        static constexpr std::uint64_t alignment = 64;
+
+        std::array<char, 8> magic = expected_magic;
+        std::uint64_t version = current_version;
+        std::uint64_t value_size = {}, node_size = {};
+        std::uint64_t vertices = {}, faces = {}, normals = {}, nodes = {};
+        std::uint64_t vertex_offset = {}, face_offset = {},
+                      normal_offset = {}, node_offset = {};
+        std::uint64_t size = {};
+        std::uint64_t position_encoding = {}, normal_encoding = {};
+
+        /// The number of bytes that the header takes in the file
+        static constexpr std::size_t bytes(std::uint64_t const version) {
+            return 8 + (version == 1 ? 12 : 14) * 8;
+        }
+
+        /// Round up to the next aligned position
+        static constexpr std::uint64_t aligned(std::uint64_t const p) {
+            return (p + alignment - 1) / alignment * alignment;
+        }
+    };
+
+
+    namespace detail {
+        /// Convert between little endian and the machine's byte order
+        template<typename T>
+        inline T little_endian(T const value) {
+            if constexpr (std::endian::native == std::endian::little) {
+                return value;
+            } else {
+                auto bytes =
+                        std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+                std::reverse(bytes.begin(), bytes.end());
+                return std::bit_cast<T>(bytes);
+            }
+        }
+        template<typename D, std::size_t N>
+        inline std::array<D, N> little_endian(std::array<D, N> v) {
+            for (auto &e : v) { e = little_endian(e); }
+            return v;
+        }
+        template<typename D>
+        inline bvh_node<D> little_endian(bvh_node<D> const &n) {
+            bvh_node<D> r;
+            r.bounds.lower = little_endian(n.bounds.lower);
+            r.bounds.upper = little_endian(n.bounds.upper);
+            r.offset = little_endian(n.offset);
+            r.count = little_endian(n.count);
+            r.axis = little_endian(n.axis);
+            return r;
+        }
+
+        inline std::uint64_t
+                mesh_cache_field(std::byte const *const p, std::size_t field) {
+            std::uint64_t v;
+            std::memcpy(&v, p + 8 + field * 8, sizeof(v));
+            return little_endian(v);
+        }
+
+        /// Write the buffer at the given position, padding up to it first
+        template<typename T>
+        void mesh_cache_write(
+                std::ostream &out,
+                std::uint64_t &written,
+                std::uint64_t const offset,
+                std::span<T const> const buffer) {
+            for (; written < offset; ++written) { out.put(0); }
+            if constexpr (std::endian::native == std::endian::little) {
+                out.write(
+                        reinterpret_cast<char const *>(buffer.data()),
+                        buffer.size_bytes());
+            } else {
+                for (auto const &v : buffer) {
+                    auto const le = little_endian(v);
+                    out.write(reinterpret_cast<char const *>(&le), sizeof(le));
+                }
+            }
+            written += buffer.size_bytes();
+        }
+
+        /// Find a buffer in a cached mesh, checking that it fits
+        template<typename T>
+        std::span<T const> mesh_cache_buffer(
+                std::span<std::byte const> const blob,
+                std::uint64_t const offset,
+                std::uint64_t const count) {
+            if (offset > blob.size()
+                or count > (blob.size() - offset) / sizeof(T)) {
+                throw felspar::overflow_error{
+                        "Mesh cache buffer runs past the end of the file",
+                        std::size_t(offset + count * sizeof(T)), blob.size()};
+            }
+            auto const start = blob.data() + offset;
+            if (reinterpret_cast<std::uintptr_t>(start) % alignof(T)) {
+                throw std::runtime_error{"Mesh cache buffer isn't aligned"};
+            }
+            return {reinterpret_cast<T const *>(start), std::size_t(count)};
+        }
+    }
+
+
+    /// Write the mesh to the stream in the mesh cache format. Returns the
+    /// number of bytes written.
+    template<typename M>
+    std::uint64_t write_mesh_cache(std::ostream &out, M const &mesh) {
+        using header_type = mesh_cache_header;
+        header_type header;
+        header.value_size = sizeof(typename M::local_coord_type);
+        header.node_size = sizeof(typename M::node_type);
+        header.vertices = mesh.vertices().size();
+        header.faces = mesh.faces().size();
+        header.normals = mesh.normals().size();
+        header.nodes = mesh.nodes().size();
+        header.position_encoding = M::position_encoding_type::encoding;
+        header.normal_encoding = M::normal_encoding_type::encoding;
+        auto const range = mesh.position_encoding().range();
+        std::uint64_t written = header_type::bytes(header.version);
+        header.vertex_offset =
+                header_type::aligned(written + sizeof(range.lower) * 2);
+        header.face_offset = header_type::aligned(
+                header.vertex_offset + mesh.vertices().size_bytes());
+        header.normal_offset = header_type::aligned(
+                header.face_offset + mesh.faces().size_bytes());
+        header.node_offset = header_type::aligned(
+                header.normal_offset + mesh.normals().size_bytes());
+        header.size = header.node_offset + mesh.nodes().size_bytes();
+
+        out.write(header.magic.data(), header.magic.size());
+        for (auto const field :
+             {header.version, header.value_size, header.node_size,
+              header.vertices, header.faces, header.normals, header.nodes,
+              header.vertex_offset, header.face_offset, header.normal_offset,
+              header.node_offset, header.size, header.position_encoding,
+              header.normal_encoding}) {
+            auto const le = detail::little_endian(field);
+            out.write(reinterpret_cast<char const *>(&le), sizeof(le));
+        }
+        for (auto const &corner : {range.lower, range.upper}) {
+            auto const le = detail::little_endian(corner);
+            out.write(reinterpret_cast<char const *>(&le), sizeof(le));
+            written += sizeof(le);
+        }
+        detail::mesh_cache_write(
+                out, written, header.vertex_offset, mesh.vertices());
+        detail::mesh_cache_write(
+                out, written, header.face_offset, mesh.faces());
+        detail::mesh_cache_write(
+                out, written, header.normal_offset, mesh.normals());
+        detail::mesh_cache_write(
+                out, written, header.node_offset, mesh.nodes());
+        return written;
+    }
+
+
+    /// Save the mesh to a mesh cache file
+    template<typename M>
+    void save_mesh_cache(std::filesystem::path const &filename, M const &mesh) {
+        std::ofstream file{filename, std::ios::binary};
+        write_mesh_cache(file, mesh);
+        if (not file) {
+            throw std::runtime_error{"Mesh cache could not be written"};
+        }
+    }
+
+
+    /// Read the header of a cached mesh
+    inline mesh_cache_header
+            read_mesh_cache_header(std::span<std::byte const> const blob) {
+        mesh_cache_header header;
+        if (blob.size() < mesh_cache_header::bytes(1)
+            or std::memcmp(
+                    blob.data(), header.magic.data(), header.magic.size())) {
+            throw std::runtime_error{"This is not a mesh cache"};
+        }
+        header.version = detail::mesh_cache_field(blob.data(), 0);
+        if (header.version < 1
+            or header.version > mesh_cache_header::current_version) {
+            throw std::runtime_error{"Unsupported mesh cache version"};
+        } else if (blob.size() < mesh_cache_header::bytes(header.version)) {
+            throw std::runtime_error{"This is not a mesh cache"};
+        }
+        std::array<std::uint64_t *, 14> const fields{
+                &header.version,       &header.value_size,
+                &header.node_size,     &header.vertices,
+                &header.faces,         &header.normals,
+                &header.nodes,         &header.vertex_offset,
+                &header.face_offset,   &header.normal_offset,
+                &header.node_offset,   &header.size,
+                &header.position_encoding, &header.normal_encoding};
+        for (std::size_t f{1};
+             f != (mesh_cache_header::bytes(header.version) - 8) / 8; ++f) {
+            *fields[f] = detail::mesh_cache_field(blob.data(), f);
+        }
+        if (header.size > blob.size()) {
+            throw felspar::overflow_error{
+                    "Mesh cache runs past the end of the file",
+                    std::size_t(header.size), blob.size()};
+        }
+        return header;
+    }
+
+
+    /// Use a cached mesh held in memory that `storage` keeps alive. On
+    /// little endian machines the mesh refers directly to the memory.
+    template<typename M>
+    M view_mesh_cache(
+            std::span<std::byte const> const blob,
+            std::shared_ptr<void const> storage) {
+        using value_type = typename M::local_coord_type;
+        using vertex_type = typename M::stored_vertex_type;
+        using face_type = typename M::face_type;
+        using normal_type = typename M::stored_normal_type;
+        using node_type = typename M::node_type;
+        using encoding_type = typename M::position_encoding_type;
+        auto const header = read_mesh_cache_header(blob);
+        if (header.value_size != sizeof(value_type)
+            or header.node_size != sizeof(node_type)) {
+            throw std::runtime_error{
+                    "Mesh cache was written for a different value type"};
+        } else if (
+                header.position_encoding != encoding_type::encoding
+                or header.normal_encoding
+                        != M::normal_encoding_type::encoding) {
+            throw std::runtime_error{
+                    "Mesh cache was written with a different encoding"};
+        }
+        extents3d<value_type> range;
+        if (header.version > 1) {
+            auto const start = mesh_cache_header::bytes(header.version);
+            if (blob.size() < start + 2 * sizeof(range.lower)) {
+                throw std::runtime_error{"This is not a mesh cache"};
+            }
+            std::memcpy(&range.lower, blob.data() + start, sizeof(range.lower));
+            std::memcpy(
+                    &range.upper, blob.data() + start + sizeof(range.lower),
+                    sizeof(range.upper));
+            range.lower = detail::little_endian(range.lower);
+            range.upper = detail::little_endian(range.upper);
+        }
+        encoding_type const positions{range};
+        auto const vertices = detail::mesh_cache_buffer<vertex_type>(
+                blob, header.vertex_offset, header.vertices);
+        auto const faces = detail::mesh_cache_buffer<face_type>(
+                blob, header.face_offset, header.faces);
+        auto const normals = detail::mesh_cache_buffer<normal_type>(
+                blob, header.normal_offset, header.normals);
+        auto const nodes = detail::mesh_cache_buffer<node_type>(
+                blob, header.node_offset, header.nodes);
+        if constexpr (std::endian::native == std::endian::little) {
+            return M{
+                    vertices, faces, normals, nodes, std::move(storage),
+                    positions};
+        } else {
+            struct buffers {
+                std::vector<vertex_type> vertices;
+                std::vector<face_type> faces;
+                std::vector<normal_type> normals;
+                std::vector<node_type> nodes;
+            };
+            auto copy = std::make_shared<buffers>();
+            auto const convert = [](auto const from, auto &to) {
+                to.reserve(from.size());
+                for (auto const &v : from) {
+                    to.push_back(detail::little_endian(v));
+                }
+            };
+            convert(vertices, copy->vertices);
+            convert(faces, copy->faces);
+            convert(normals, copy->normals);
+            convert(nodes, copy->nodes);
+            return M{
+                    copy->vertices, copy->faces, copy->normals, copy->nodes,
+                    copy, positions};
+        }
+    }
+
+
+    /// Load a mesh from a mesh cache file. The file stays mapped for as
+    /// long as the mesh, or any copy of it, is alive.
+    template<typename M>
+    M load_mesh_cache(std::filesystem::path const &filename) {
+        auto file = std::make_shared<mapped_file const>(filename);
+        auto const blob = file->bytes();
+        return view_mesh_cache<M>(blob, std::move(file));
+    }
+
+
+}
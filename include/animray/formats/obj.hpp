@@ -0,0 +1,310 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/formats/mapped-file.hpp>
+#include <animray/threading/parallel.hpp>
+#include <felspar/exceptions/overflow_error.hpp>
+#include <felspar/exceptions/underflow_error.hpp>
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// The geometry read from one part of an OBJ file
+        template<typename D>
+        struct obj_chunk {
+            /// The smallest number of bytes worth handing to a thread
+            static constexpr std::size_t smallest = 16 << 10;
+            /// Marks a corner without a normal
+            static constexpr std::int64_t missing =
+                    std::numeric_limits<std::int64_t>::min();
+
+            /// Zero based vertex and normal indexes for a triangle corner
+            struct corner {
+                std::int64_t vertex, normal;
+            };
+
+            std::vector<std::array<D, 3>> vertices, normals;
+            /// Three corners for each triangle
+            std::vector<corner> corners;
+            /// Positions in `corners` where negative (relative) indexes were
+            /// used. These are only known relative to the start of the chunk
+            /// until the earlier chunks have been counted
+            std::vector<std::size_t> relative_vertices, relative_normals;
+            /// True if any corner has no normal
+            bool missing_normals = false;
+
+            static bool blank(char const c) { return c == ' ' or c == '\t'; }
+            static char const *skip(char const *p, char const *const e) {
+                while (p != e and blank(*p)) { ++p; }
+                return p;
+            }
+            template<typename T>
+            static char const *
+                    number(char const *p, char const *const e, T &value) {
+                p = skip(p, e);
+                if (p != e and *p == '+') { ++p; }
+                auto const [next, error] = std::from_chars(p, e, value);
+                if (error != std::errc{}) {
+                    throw std::runtime_error{"Malformed number in OBJ file"};
+                }
+                return next;
+            }
+
+            char const *coordinates(
+                    char const *p, char const *const e, auto &into) {
+                auto &c = into.emplace_back();
+                p = number(p, e, c[0]);
+                p = number(p, e, c[1]);
+                return number(p, e, c[2]);
+            }
+
+            void add(std::int64_t vertex, std::int64_t normal) {
+                if (vertex < 0) {
+                    relative_vertices.push_back(corners.size());
+                    vertex += std::int64_t(vertices.size());
+                } else if (vertex > 0) {
+                    vertex -= 1;
+                } else {
+                    throw std::runtime_error{"OBJ vertex indexes start at 1"};
+                }
+                if (normal < 0) {
+                    relative_normals.push_back(corners.size());
+                    normal += std::int64_t(normals.size());
+                } else if (normal > 0) {
+                    normal -= 1;
+                } else {
+                    normal = missing;
+                    missing_normals = true;
+                }
+                corners.push_back({vertex, normal});
+            }
+
+            /// Read a face, fanning polygons out into triangles
+            void face(char const *p, char const *const e) {
+                std::array<std::int64_t, 2> first{}, previous{};
+                std::size_t count{};
+                while (true) {
+                    p = skip(p, e);
+                    if (p == e or *p == '\r' or *p == '#') { break; }
+                    std::int64_t vertex{}, texture{}, normal{};
+                    p = number(p, e, vertex);
+                    if (p != e and *p == '/') {
+                        if (++p != e and *p != '/') {
+                            p = number(p, e, texture);
+                        }
+                        if (p != e and *p == '/') {
+                            p = number(p + 1, e, normal);
+                        }
+                    }
+                    if (count == 0) {
+                        first = {vertex, normal};
+                    } else if (count >= 2) {
+                        add(first[0], first[1]);
+                        add(previous[0], previous[1]);
+                        add(vertex, normal);
+                    }
+                    previous = {vertex, normal};
+                    ++count;
+                }
+                if (count < 3) {
+                    throw felspar::underflow_error{
+                            "OBJ faces need at least three vertices", count};
+                }
+            }
+
+            void parse(char const *p, char const *const e) {
+                while (p != e) {
+                    auto eol = static_cast<char const *>(
+                            std::memchr(p, '\n', std::size_t(e - p)));
+                    if (not eol) { eol = e; }
+                    p = skip(p, eol);
+                    auto const length = eol - p;
+                    if (length >= 2 and p[0] == 'v' and blank(p[1])) {
+                        coordinates(p + 2, eol, vertices);
+                    } else if (
+                            length >= 3 and p[0] == 'v' and p[1] == 'n'
+                            and blank(p[2])) {
+                        coordinates(p + 3, eol, normals);
+                    } else if (length >= 2 and p[0] == 'f' and blank(p[1])) {
+                        face(p + 2, eol);
+                    }
+                    p = eol == e ? e : eol + 1;
+                }
+            }
+        };
+    }
+
+
+    /**
+     * ## Wavefront OBJ
+     *
+     * Builds a mesh from the vertices, vertex normals and faces found in the
+     * text of an OBJ file. Everything else (texture co-ordinates, groups,
+     * materials etc.) is skipped. The text is split into chunks at line
+     * boundaries which are parsed on separate threads and then joined.
+     *
+     * Normals are only used if every face corner names one. A vertex that is
+     * used with more than one normal is duplicated so that the mesh can keep
+     * one normal per vertex.
+     */
+    template<typename M>
+    M parse_obj(
+            std::string_view const text,
+            std::size_t const threads = threading::default_threads()) {
+        using chunk_type = detail::obj_chunk<typename M::local_coord_type>;
+        using index_type = typename M::index_type;
+
+        std::size_t const parts = std::clamp(
+                text.size() / chunk_type::smallest, std::size_t{1},
+                std::max(threads * 4, std::size_t{1}));
+        std::vector<std::size_t> starts(parts + 1, text.size());
+        starts[0] = 0;
+        for (std::size_t part{1}; part < parts; ++part) {
+            auto const end = text.find(
+                    '\n',
+                    std::max(starts[part - 1], text.size() * part / parts));
+            starts[part] = end == text.npos ? text.size() : end + 1;
+        }
+        std::vector<chunk_type> chunks(parts);
+        threading::parallel_for(parts, threads, [&](std::size_t const part) {
+            chunks[part].parse(
+                    text.data() + starts[part], text.data() + starts[part + 1]);
+        });
+
+        std::vector<std::size_t> vertex_base(parts + 1), normal_base(parts + 1),
+                corner_base(parts + 1);
+        bool missing_normals = false;
+        for (std::size_t part{}; part != parts; ++part) {
+            vertex_base[part + 1] =
+                    vertex_base[part] + chunks[part].vertices.size();
+            normal_base[part + 1] =
+                    normal_base[part] + chunks[part].normals.size();
+            corner_base[part + 1] =
+                    corner_base[part] + chunks[part].corners.size();
+            missing_normals = missing_normals or chunks[part].missing_normals;
+        }
+        std::size_t const vertex_count = vertex_base.back();
+        std::size_t const normal_count = normal_base.back();
+        if (vertex_count > std::numeric_limits<index_type>::max()) {
+            throw felspar::overflow_error{
+                    "There are too many vertices for the mesh index type",
+                    vertex_count,
+                    std::size_t(std::numeric_limits<index_type>::max())};
+        }
+
+        std::vector<typename M::vertex_type> vertices(vertex_count);
+        std::vector<typename M::face_type> faces(corner_base.back() / 3);
+        auto const check = [](std::int64_t const index,
+                              std::size_t const count) {
+            if (index < 0) {
+                throw felspar::underflow_error{
+                        "OBJ face refers to a vertex before the first", index};
+            } else if (std::size_t(index) >= count) {
+                throw felspar::overflow_error{
+                        "OBJ face refers to a vertex past the last",
+                        std::size_t(index), count};
+            }
+        };
+        threading::parallel_for(parts, threads, [&](std::size_t const part) {
+            auto &chunk = chunks[part];
+            std::copy(
+                    chunk.vertices.begin(), chunk.vertices.end(),
+                    vertices.begin() + vertex_base[part]);
+            for (auto const c : chunk.relative_vertices) {
+                chunk.corners[c].vertex += std::int64_t(vertex_base[part]);
+            }
+            for (auto const c : chunk.relative_normals) {
+                chunk.corners[c].normal += std::int64_t(normal_base[part]);
+            }
+            for (std::size_t c{}; c != chunk.corners.size(); ++c) {
+                auto const &corner = chunk.corners[c];
+                check(corner.vertex, vertex_count);
+                faces[(corner_base[part] + c) / 3][c % 3] =
+                        index_type(corner.vertex);
+            }
+        });
+
+        if (missing_normals or normal_count == 0) {
+            return M{std::move(vertices), std::move(faces)};
+        }
+
+        std::vector<typename M::normal_type> normals(normal_count);
+        for (std::size_t part{}; part != parts; ++part) {
+            std::copy(
+                    chunks[part].normals.begin(), chunks[part].normals.end(),
+                    normals.begin() + normal_base[part]);
+        }
+        std::vector<typename M::normal_type> vertex_normals(vertex_count);
+        std::vector<std::int64_t> assigned(
+                vertex_count, chunk_type::missing);
+        std::map<std::pair<index_type, std::int64_t>, index_type> duplicates;
+        for (std::size_t part{}; part != parts; ++part) {
+            auto const &corners = chunks[part].corners;
+            for (std::size_t c{}; c != corners.size(); ++c) {
+                check(corners[c].normal, normal_count);
+                auto &index = faces[(corner_base[part] + c) / 3][c % 3];
+                auto &normal = assigned[index];
+                if (normal == chunk_type::missing) {
+                    normal = corners[c].normal;
+                    vertex_normals[index] = normals[normal];
+                } else if (normal != corners[c].normal) {
+                    auto const key = std::pair{index, corners[c].normal};
+                    if (auto const d = duplicates.find(key);
+                        d != duplicates.end()) {
+                        index = d->second;
+                    } else {
+                        auto const copy = index_type(vertices.size());
+                        vertices.push_back(vertices[index]);
+                        vertex_normals.push_back(normals[corners[c].normal]);
+                        duplicates.emplace(key, copy);
+                        index = copy;
+                    }
+                }
+            }
+        }
+        return M{std::move(vertices), std::move(faces),
+                 std::move(vertex_normals)};
+    }
+
+
+    /// Load a mesh from an OBJ file
+    template<typename M>
+    M load_obj(
+            std::filesystem::path const &filename,
+            std::size_t const threads = threading::default_threads()) {
+        mapped_file const file{filename};
+        return parse_obj<M>(file.text(), threads);
+    }
+
+
+}
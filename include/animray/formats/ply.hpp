@@ -0,0 +1,480 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/formats/mapped-file.hpp>
+#include <animray/threading/parallel.hpp>
+#include <felspar/exceptions/overflow_error.hpp>
+#include <felspar/exceptions/underflow_error.hpp>
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// The types that PLY properties can have
+        enum class ply_type {
+            int8,
+            uint8,
+            int16,
+            uint16,
+            int32,
+            uint32,
+            float32,
+            float64
+        };
+
+        inline ply_type ply_type_named(std::string_view const name) {
+            if (name == "char" or name == "int8") {
+                return ply_type::int8;
+            } else if (name == "uchar" or name == "uint8") {
+                return ply_type::uint8;
+            } else if (name == "short" or name == "int16") {
+                return ply_type::int16;
+            } else if (name == "ushort" or name == "uint16") {
+                return ply_type::uint16;
+            } else if (name == "int" or name == "int32") {
+                return ply_type::int32;
+            } else if (name == "uint" or name == "uint32") {
+                return ply_type::uint32;
+            } else if (name == "float" or name == "float32") {
+                return ply_type::float32;
+            } else if (name == "double" or name == "float64") {
+                return ply_type::float64;
+            } else {
+                throw std::runtime_error{"Unknown PLY property type"};
+            }
+        }
+
+        inline std::size_t ply_size(ply_type const type) {
+            switch (type) {
+            case ply_type::int8:
+            case ply_type::uint8: return 1;
+            case ply_type::int16:
+            case ply_type::uint16: return 2;
+            case ply_type::int32:
+            case ply_type::uint32:
+            case ply_type::float32: return 4;
+            case ply_type::float64: return 8;
+            }
+            return 0;
+        }
+
+        template<typename R>
+        inline R ply_raw(std::byte const *const p, bool const swap) {
+            std::array<std::byte, sizeof(R)> bytes;
+            std::memcpy(bytes.data(), p, sizeof(R));
+            if (swap) { std::reverse(bytes.begin(), bytes.end()); }
+            return std::bit_cast<R>(bytes);
+        }
+
+        /// Read a single PLY value and convert it to `T`
+        template<typename T>
+        inline T ply_value(
+                std::byte const *const p,
+                ply_type const type,
+                bool const swap) {
+            switch (type) {
+            case ply_type::int8: return T(ply_raw<std::int8_t>(p, swap));
+            case ply_type::uint8: return T(ply_raw<std::uint8_t>(p, swap));
+            case ply_type::int16: return T(ply_raw<std::int16_t>(p, swap));
+            case ply_type::uint16: return T(ply_raw<std::uint16_t>(p, swap));
+            case ply_type::int32: return T(ply_raw<std::int32_t>(p, swap));
+            case ply_type::uint32: return T(ply_raw<std::uint32_t>(p, swap));
+            case ply_type::float32: return T(ply_raw<float>(p, swap));
+            case ply_type::float64: return T(ply_raw<double>(p, swap));
+            }
+            return T{};
+        }
+
+        struct ply_property {
+            std::string_view name;
+            ply_type type;
+            /// The type of the length for list properties
+            std::optional<ply_type> count = {};
+        };
+
+        struct ply_element {
+            std::string_view name;
+            std::size_t count;
+            std::vector<ply_property> properties = {};
+
+            /// True if every record is the same size
+            bool fixed() const {
+                for (auto const &p : properties) {
+                    if (p.count) { return false; }
+                }
+                return true;
+            }
+            /// The size of each record if they're fixed size
+            std::size_t stride() const {
+                std::size_t s{};
+                for (auto const &p : properties) { s += ply_size(p.type); }
+                return s;
+            }
+            /// The position of the named property
+            std::optional<std::size_t> find(std::string_view const n) const {
+                for (std::size_t i{}; i != properties.size(); ++i) {
+                    if (properties[i].name == n) { return i; }
+                }
+                return {};
+            }
+            /// The position in a fixed size record of the property
+            std::size_t offset(std::size_t const property) const {
+                std::size_t o{};
+                for (std::size_t i{}; i != property; ++i) {
+                    o += ply_size(properties[i].type);
+                }
+                return o;
+            }
+        };
+
+        struct ply_header {
+            /// True if the file's byte order isn't the machine's
+            bool swap;
+            std::vector<ply_element> elements;
+            /// Where the element data starts
+            std::size_t data;
+        };
+
+        inline ply_header
+                ply_read_header(std::span<std::byte const> const file) {
+            std::string_view const text{
+                    reinterpret_cast<char const *>(file.data()), file.size()};
+            if (not text.starts_with("ply")) {
+                throw std::runtime_error{"This is not a PLY file"};
+            }
+            auto const end = text.find("end_header");
+            if (end == text.npos) {
+                throw std::runtime_error{"The PLY header has no end"};
+            }
+            auto const data = text.find('\n', end);
+            if (data == text.npos) {
+                throw std::runtime_error{"The PLY file has no data"};
+            }
+            std::optional<bool> swap;
+            std::vector<ply_element> elements;
+            for (std::size_t line{}; line < end;) {
+                auto const eol = text.find('\n', line);
+                std::array<std::string_view, 5> words;
+                std::size_t count{};
+                for (auto p = line; p < eol and count != words.size();) {
+                    auto const word = text.find_first_not_of(" \t\r", p);
+                    if (word >= eol) { break; }
+                    auto const after = std::min(
+                            text.find_first_of(" \t\r", word), eol);
+                    words[count++] = text.substr(word, after - word);
+                    p = after;
+                }
+                line = eol + 1;
+                if (count == 3 and words[0] == "format") {
+                    if (words[1] == "binary_little_endian") {
+                        swap = std::endian::native != std::endian::little;
+                    } else if (words[1] == "binary_big_endian") {
+                        swap = std::endian::native != std::endian::big;
+                    } else {
+                        throw std::runtime_error{
+                                "Only binary PLY files can be loaded"};
+                    }
+                } else if (count == 3 and words[0] == "element") {
+                    std::size_t number{};
+                    auto const [_, error] = std::from_chars(
+                            words[2].data(),
+                            words[2].data() + words[2].size(), number);
+                    if (error != std::errc{}) {
+                        throw std::runtime_error{
+                                "Malformed PLY element count"};
+                    }
+                    elements.push_back({words[1], number});
+                } else if (count and words[0] == "property") {
+                    if (elements.empty()) {
+                        throw std::runtime_error{
+                                "PLY property found before any element"};
+                    } else if (count == 5 and words[1] == "list") {
+                        elements.back().properties.push_back(
+                                {words[4], ply_type_named(words[3]),
+                                 ply_type_named(words[2])});
+                    } else if (count == 3) {
+                        elements.back().properties.push_back(
+                                {words[2], ply_type_named(words[1])});
+                    } else {
+                        throw std::runtime_error{"Malformed PLY property"};
+                    }
+                }
+            }
+            if (not swap) {
+                throw std::runtime_error{"The PLY file format is missing"};
+            }
+            return {*swap, std::move(elements), data + 1};
+        }
+
+        /// Move past one property of a record
+        inline std::byte const *ply_skip(
+                ply_property const &property,
+                std::byte const *p,
+                std::byte const *const end,
+                bool const swap) {
+            std::size_t bytes = ply_size(property.type);
+            if (property.count) {
+                auto const size = ply_size(*property.count);
+                if (std::size_t(end - p) < size) {
+                    throw std::runtime_error{"The PLY file is truncated"};
+                }
+                bytes *= ply_value<std::size_t>(p, *property.count, swap);
+                p += size;
+            }
+            if (std::size_t(end - p) < bytes) {
+                throw std::runtime_error{"The PLY file is truncated"};
+            }
+            return p + bytes;
+        }
+
+        /// Blocks of records handed to each thread
+        constexpr std::size_t ply_block = 1 << 16;
+    }
+
+
+    /**
+     * ## Binary PLY
+     *
+     * Builds a mesh from the `vertex` and `face` elements of a binary PLY
+     * file in either byte order. Vertex normals are used if the `nx`, `ny`
+     * and `nz` properties are all present. Other elements and properties are
+     * skipped.
+     *
+     * Vertices are read in parallel. Faces are first read in parallel
+     * assuming they are all triangles, and only if that turns out to be
+     * wrong are they read again one at a time with polygons fanned out into
+     * triangles.
+     */
+    template<typename M>
+    M parse_ply(
+            std::span<std::byte const> const file,
+            std::size_t const threads = threading::default_threads()) {
+        using value_type = typename M::local_coord_type;
+        using index_type = typename M::index_type;
+        auto const header = detail::ply_read_header(file);
+        bool const swap = header.swap;
+        std::byte const *p = file.data() + header.data;
+        std::byte const *const end = file.data() + file.size();
+        auto const blocks = [](std::size_t const count) {
+            return (count + detail::ply_block - 1) / detail::ply_block;
+        };
+
+        std::vector<typename M::vertex_type> vertices;
+        std::vector<typename M::normal_type> normals;
+        std::vector<typename M::face_type> faces;
+        for (auto const &element : header.elements) {
+            if (element.name == "vertex") {
+                if (not element.fixed()) {
+                    throw std::runtime_error{
+                            "PLY vertices can't have list properties"};
+                }
+                struct field {
+                    std::size_t offset;
+                    detail::ply_type type;
+                };
+                auto const property = [&](std::string_view const name)
+                        -> std::optional<field> {
+                    if (auto const i = element.find(name); i) {
+                        return field{
+                                element.offset(*i),
+                                element.properties[*i].type};
+                    } else {
+                        return {};
+                    }
+                };
+                std::array const position{
+                        property("x"), property("y"), property("z")};
+                std::array const normal{
+                        property("nx"), property("ny"), property("nz")};
+                if (not position[0] or not position[1] or not position[2]) {
+                    throw std::runtime_error{
+                            "PLY vertices must have x, y and z"};
+                }
+                auto const stride = element.stride();
+                if (std::size_t(end - p) / stride < element.count) {
+                    throw std::runtime_error{"The PLY file is truncated"};
+                }
+                bool const has_normals = normal[0] and normal[1] and normal[2];
+                vertices.resize(element.count);
+                if (has_normals) { normals.resize(element.count); }
+                threading::parallel_for(
+                        blocks(element.count), threads,
+                        [&](std::size_t const block) {
+                            auto const first = block * detail::ply_block;
+                            auto const last = std::min(
+                                    element.count, first + detail::ply_block);
+                            for (auto v = first; v != last; ++v) {
+                                auto const record = p + v * stride;
+                                for (std::size_t a{}; a != 3; ++a) {
+                                    vertices[v][a] = detail::ply_value<
+                                            value_type>(
+                                            record + position[a]->offset,
+                                            position[a]->type, swap);
+                                    if (has_normals) {
+                                        normals[v][a] = detail::ply_value<
+                                                value_type>(
+                                                record + normal[a]->offset,
+                                                normal[a]->type, swap);
+                                    }
+                                }
+                            }
+                        });
+                p += element.count * stride;
+            } else if (element.name == "face") {
+                auto indexes = element.find("vertex_indices");
+                if (not indexes) { indexes = element.find("vertex_index"); }
+                if (not indexes or not element.properties[*indexes].count) {
+                    throw std::runtime_error{
+                            "PLY faces must have a vertex index list"};
+                }
+                auto const &list = element.properties[*indexes];
+                auto const count_size = detail::ply_size(*list.count);
+                auto const index_size = detail::ply_size(list.type);
+                auto const index = [&](std::byte const *const at) {
+                    auto const i = detail::ply_value<std::int64_t>(
+                            at, list.type, swap);
+                    if (i < 0) {
+                        throw felspar::underflow_error{
+                                "PLY face vertex index is negative", i};
+                    }
+                    return index_type(i);
+                };
+
+                // If this is the only list then records made only of
+                // triangles are all the same size. Once a record isn't a
+                // triangle the later ones are misaligned, so nothing is
+                // checked here. A negative index also falls back to the
+                // sequential pass, which reports it
+                std::size_t lists{}, before{}, stride{};
+                for (std::size_t i{}; i != element.properties.size(); ++i) {
+                    auto const &property = element.properties[i];
+                    auto const size = detail::ply_size(property.type);
+                    if (property.count) {
+                        ++lists;
+                        stride += detail::ply_size(*property.count) + 3 * size;
+                    } else {
+                        stride += size;
+                    }
+                    if (i < *indexes) { before += size; }
+                }
+                std::atomic<bool> triangles{
+                        lists == 1
+                        and std::size_t(end - p) / stride >= element.count};
+                if (triangles) {
+                    faces.resize(element.count);
+                    threading::parallel_for(
+                            blocks(element.count), threads,
+                            [&](std::size_t const block) {
+                                auto const first = block * detail::ply_block;
+                                auto const last = std::min(
+                                        element.count,
+                                        first + detail::ply_block);
+                                for (auto f = first;
+                                     f != last and triangles; ++f) {
+                                    auto const at = p + f * stride + before;
+                                    if (detail::ply_value<std::size_t>(
+                                                at, *list.count, swap)
+                                        != 3) {
+                                        triangles = false;
+                                    } else {
+                                        for (std::size_t c{}; c != 3; ++c) {
+                                            auto const i = detail::ply_value<
+                                                    std::int64_t>(
+                                                    at + count_size
+                                                            + c * index_size,
+                                                    list.type, swap);
+                                            if (i < 0) { triangles = false; }
+                                            faces[f][c] = index_type(i);
+                                        }
+                                    }
+                                }
+                            });
+                }
+                if (triangles) {
+                    p += element.count * stride;
+                } else {
+                    faces.clear();
+                    for (std::size_t f{}; f != element.count; ++f) {
+                        std::byte const *at = nullptr;
+                        for (std::size_t i{}; i != element.properties.size();
+                             ++i) {
+                            if (i == *indexes) { at = p; }
+                            p = detail::ply_skip(
+                                    element.properties[i], p, end, swap);
+                        }
+                        auto const corners = detail::ply_value<std::size_t>(
+                                at, *list.count, swap);
+                        if (corners < 3) {
+                            throw felspar::underflow_error{
+                                    "PLY faces need at least three vertices",
+                                    corners};
+                        }
+                        auto const corner = [&](std::size_t const c) {
+                            return index(at + count_size + c * index_size);
+                        };
+                        for (std::size_t c{2}; c < corners; ++c) {
+                            faces.push_back(
+                                    {corner(0), corner(c - 1), corner(c)});
+                        }
+                    }
+                }
+            } else if (element.fixed()) {
+                auto const stride = element.stride();
+                if (std::size_t(end - p) / std::max(stride, std::size_t{1})
+                    < element.count) {
+                    throw std::runtime_error{"The PLY file is truncated"};
+                }
+                p += element.count * stride;
+            } else {
+                for (std::size_t r{}; r != element.count; ++r) {
+                    for (auto const &property : element.properties) {
+                        p = detail::ply_skip(property, p, end, swap);
+                    }
+                }
+            }
+        }
+        return M{std::move(vertices), std::move(faces), std::move(normals)};
+    }
+
+
+    /// Load a mesh from a binary PLY file
+    template<typename M>
+    M load_ply(
+            std::filesystem::path const &filename,
+            std::size_t const threads = threading::default_threads()) {
+        mapped_file const file{filename};
+        return parse_ply<M>(file.bytes(), threads);
+    }
+
+
+}
@@ -0,0 +1,224 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/extents3d.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace animray {
+
+
+    /**
+     * # Bounding volume hierarchy
+     *
+     * A flat array of nodes describing a binary tree of boxes over a set of
+     * primitives. The first child of an interior node is always stored
+     * directly after its parent. Nodes are plain data so that a hierarchy
+     * can be saved and then used directly from a file mapping.
+     */
+    template<typename D>
+    struct bvh_node {
+        /// The extents of everything below this node
+        extents3d<D> bounds;
+        /// For a leaf the first primitive, otherwise the index of the second
+        /// child
+        std::uint32_t offset{};
+        /// The number of primitives in a leaf, zero for interior nodes
+        std::uint16_t count{};
+        /// The axis the children of an interior node were split on
+        std::uint16_t axis{};
+
+        /// True if this node refers directly to primitives
+        bool leaf() const { return count != 0; }
+    };
+
+
+    namespace detail {
+        template<typename D>
+        struct bvh_builder {
+            std::vector<extents3d<D>> const &bounds;
+            std::vector<typename extents3d<D>::corner_type> centres;
+            std::vector<std::uint32_t> &order;
+            std::size_t leaf_size;
+            std::vector<bvh_node<D>> nodes = {};
+
+            static constexpr std::size_t bins = 16;
+            /// Leaves are allowed to grow this large if the surface area
+            /// heuristic says splitting doesn't pay
+            static constexpr std::size_t largest_leaf = 16;
+            /// Past this depth only median splits are used, which bounds the
+            /// stack needed to walk the tree
+            static constexpr std::size_t deepest = 32;
+
+            void build(
+                    std::size_t const begin,
+                    std::size_t const end,
+                    std::size_t const depth) {
+                std::size_t const index = nodes.size();
+                nodes.emplace_back();
+                extents3d<D> box, centroids;
+                for (auto p = begin; p != end; ++p) {
+                    box.extend(bounds[order[p]]);
+                    centroids.extend(centres[order[p]]);
+                }
+                nodes[index].bounds = box;
+                std::size_t const count = end - begin;
+                if (count <= leaf_size) { return leaf(index, begin, count); }
+
+                auto const axis = centroids.longest_axis();
+                auto const low = centroids.lower[axis];
+                auto const width = centroids.upper[axis] - low;
+                auto mid = begin + count / 2;
+                if (width > D{} and depth < deepest) {
+                    auto const bin = [&](std::uint32_t const p) {
+                        auto const b = std::size_t(
+                                bins * ((centres[p][axis] - low) / width));
+                        return b < bins ? b : bins - 1;
+                    };
+                    std::array<extents3d<D>, bins> bin_box;
+                    std::array<std::size_t, bins> bin_count{};
+                    for (auto p = begin; p != end; ++p) {
+                        auto const b = bin(order[p]);
+                        bin_box[b].extend(bounds[order[p]]);
+                        ++bin_count[b];
+                    }
+                    // Sweep from the right to find the cost of everything
+                    // to the right of each split plane
+                    std::array<D, bins> right_cost{};
+                    extents3d<D> right;
+                    std::size_t right_count{};
+                    for (std::size_t b = bins - 1; b > 0; --b) {
+                        right.extend(bin_box[b]);
+                        right_count += bin_count[b];
+                        right_cost[b] = right.area() * D(right_count);
+                    }
+                    extents3d<D> left;
+                    std::size_t left_count{}, best{};
+                    D best_cost = std::numeric_limits<D>::max();
+                    for (std::size_t b = 0; b + 1 < bins; ++b) {
+                        left.extend(bin_box[b]);
+                        left_count += bin_count[b];
+                        auto const cost =
+                                left.area() * D(left_count) + right_cost[b + 1];
+                        if (cost < best_cost) {
+                            best_cost = cost;
+                            best = b;
+                        }
+                    }
+                    if (count <= largest_leaf
+                        and best_cost >= box.area() * D(count)) {
+                        return leaf(index, begin, count);
+                    }
+                    mid = std::partition(
+                                  order.begin() + begin, order.begin() + end,
+                                  [&](auto const p) { return bin(p) <= best; })
+                            - order.begin();
+                }
+                if (mid == begin or mid == end) {
+                    // Fall back to a median split when the bins can't
+                    // separate the primitives
+                    mid = begin + count / 2;
+                    std::nth_element(
+                            order.begin() + begin, order.begin() + mid,
+                            order.begin() + end,
+                            [&](auto const l, auto const r) {
+                                return centres[l][axis] < centres[r][axis];
+                            });
+                }
+                nodes[index].axis = std::uint16_t(axis);
+                build(begin, mid, depth + 1);
+                nodes[index].offset = std::uint32_t(nodes.size());
+                build(mid, end, depth + 1);
+            }
+
+            void leaf(std::size_t const index,
+                      std::size_t const begin,
+                      std::size_t const count) {
+                nodes[index].offset = std::uint32_t(begin);
+                nodes[index].count = std::uint16_t(count);
+            }
+        };
+    }
+
+
+    /// Build a hierarchy over primitives with the given extents. `order` is
+    /// set to the primitive indices in the order that the leaves refer to
+    /// them.
+    template<typename D>
+    std::vector<bvh_node<D>> build_bvh(
+            std::vector<extents3d<D>> const &bounds,
+            std::vector<std::uint32_t> &order,
+            std::size_t const leaf_size = 4) {
+        order.resize(bounds.size());
+        for (std::size_t p{}; p != order.size(); ++p) {
+            order[p] = std::uint32_t(p);
+        }
+        detail::bvh_builder<D> builder{bounds, {}, order, leaf_size};
+        builder.centres.reserve(bounds.size());
+        for (auto const &b : bounds) { builder.centres.push_back(b.centre()); }
+        if (bounds.size()) { builder.build(0, bounds.size(), 0); }
+        return std::move(builder.nodes);
+    }
+
+
+    /// Walk the leaves of the hierarchy that the ray enters before `limit`,
+    /// nearer children first. The ray is given as its origin and the
+    /// reciprocal of its direction. `leaf(first, count)` returns true to end
+    /// the walk, and may reduce `limit` as closer hits are found. Returns
+    /// true if the walk was ended by `leaf`.
+    template<typename D, typename L>
+    bool traverse_bvh(
+            std::span<bvh_node<D> const> const nodes,
+            typename extents3d<D>::corner_type const &from,
+            typename extents3d<D>::corner_type const &inverse,
+            D const &limit,
+            L &&leaf) {
+        if (nodes.empty()) { return false; }
+        std::array<std::uint32_t, 64> stack;
+        std::size_t top{};
+        stack[top++] = 0;
+        while (top) {
+            auto const &node = nodes[stack[--top]];
+            if (not node.bounds.entry(from, inverse, limit)) { continue; }
+            if (node.leaf()) {
+                if (leaf(node.offset, node.count)) { return true; }
+            } else {
+                auto const first = std::uint32_t(&node - nodes.data()) + 1;
+                if (inverse[node.axis] < D{}) {
+                    stack[top++] = first;
+                    stack[top++] = node.offset;
+                } else {
+                    stack[top++] = node.offset;
+                    stack[top++] = first;
+                }
+            }
+        }
+        return false;
+    }
+
+
+}
@@ -23,6 +23,10 @@
 #pragma once
 
 
+#include <animray/mixins/setup.hpp>
+#include <animray/occluder.hpp>
+
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -65,12 +69,14 @@ namespace animray {
         template<typename R, typename E>
         std::optional<intersection_type>
                 intersects(const R &by, const E epsilon) const {
+            // Every instance is struck by the same ray
+            auto const &ray = set_up(by);
             std::optional<intersection_type> result;
             local_coord_type result_dot{};
             for (const auto &instance : instances) {
                 if (result) {
                     std::optional<intersection_type> intersection(
-                            instance.intersects(by, epsilon));
+                            instance.intersects(ray, epsilon));
                     if (intersection) {
                         local_coord_type dot =
                                 (intersection->from - by.from).dot();
@@ -80,7 +86,7 @@ namespace animray {
                         }
                     }
                 } else {
-                    result = instance.intersects(by, epsilon);
+                    result = instance.intersects(ray, epsilon);
                     if (result) { result_dot = (result->from - by.from).dot(); }
                 }
             }
@@ -90,13 +96,37 @@ namespace animray {
         /// Occlusion check
         template<typename R, typename E>
         bool occludes(const R &by, const E epsilon) const {
+            auto const &ray = set_up(by);
             return std::find_if(
                            instances.begin(), instances.end(),
-                           [&by, epsilon](const instance_type &instance) {
-                               return instance.occludes(by, epsilon);
+                           [&ray, epsilon](const instance_type &instance) {
+                               return instance.occludes(ray, epsilon);
                            })
                     != instances.end();
         }
+
+        /// The number of the instance that occludes the ray, if any. See
+        /// `occluder_of`
+        template<typename R, typename E>
+        std::optional<std::size_t>
+                occluder(const R &by, const E epsilon) const {
+            auto const &ray = set_up(by);
+            for (std::size_t i{}; i != instances.size(); ++i) {
+                if (auto const part = occluder_of(instances[i], ray, epsilon)) {
+                    return i + instances.size() * *part;
+                }
+            }
+            return {};
+        }
+        /// Check only the instance with the occluder number `at`
+        template<typename R, typename E>
+        bool occludes(const R &by, const E epsilon, std::size_t const at)
+                const {
+            if (instances.empty()) { return false; }
+            return occludes_at(
+                    instances[at % instances.size()], set_up(by), epsilon,
+                    at / instances.size());
+        }
     };
 
 
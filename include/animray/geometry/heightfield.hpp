@@ -0,0 +1,382 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/film.hpp>
+#include <animray/geometry/mesh.hpp>
+
+
+namespace animray {
+
+
+    /**
+     * # Heightfield
+     *
+     * A terrain made from a grid of heights. The sample at column `x` and
+     * row `y` of the film is at `(x, y, height)` and each square of four
+     * samples is split into two triangles. Normals are interpolated from
+     * the slope of the grid around each sample.
+     *
+     * Rays walk the grid cell by cell. Above the grid is a pyramid where
+     * each level records the lowest and highest heights of two by two
+     * cells of the level below it, so the walk starts on the coarsest level
+     * and only moves down into cells whose height range the ray passes
+     * through. Only the heights and the pyramid are stored, which is far
+     * smaller than a triangle mesh of the same terrain.
+     */
+    template<typename I, typename D = typename I::local_coord_type>
+    class heightfield {
+      public:
+        /// The type of the local coordinates used
+        using local_coord_type = D;
+        /// Type of intersection to be returned
+        using intersection_type = I;
+        /// The type of the heights
+        using film_type = film<float>;
+
+        /// Make a heightfield from the heights in the film. The film must
+        /// have at least two columns and two rows
+        explicit heightfield(film_type const &heights)
+        : m_columns{heights.width()}, m_rows{heights.height()} {
+            if (m_columns < 2) {
+                throw felspar::underflow_error{
+                        "A heightfield needs at least two columns",
+                        m_columns};
+            } else if (m_rows < 2) {
+                throw felspar::underflow_error{
+                        "A heightfield needs at least two rows", m_rows};
+            }
+            m_heights.reserve(m_columns * m_rows);
+            for (std::size_t y{}; y != m_rows; ++y) {
+                for (std::size_t x{}; x != m_columns; ++x) {
+                    m_heights.push_back(heights[x][y]);
+                }
+            }
+            for (std::size_t level{1}; cells(level - 1, 0) > 1
+                 or cells(level - 1, 1) > 1;
+                 ++level) {
+                auto &next = m_levels.emplace_back();
+                next.reserve(cells(level, 0) * cells(level, 1));
+                for (std::size_t y{}; y != cells(level, 1); ++y) {
+                    for (std::size_t x{}; x != cells(level, 0); ++x) {
+                        auto r = range(level - 1, 2 * x, 2 * y);
+                        for (auto const &[cx, cy] :
+                             {std::pair{2 * x + 1, 2 * y},
+                              std::pair{2 * x, 2 * y + 1},
+                              std::pair{2 * x + 1, 2 * y + 1}}) {
+                            if (cx < cells(level - 1, 0)
+                                and cy < cells(level - 1, 1)) {
+                                auto const c = range(level - 1, cx, cy);
+                                r.lower = std::min(r.lower, c.lower);
+                                r.upper = std::max(r.upper, c.upper);
+                            }
+                        }
+                        next.push_back(r);
+                    }
+                }
+            }
+            auto const top = range(levels() - 1, 0, 0);
+            m_bounds.lower = {
+                    local_coord_type{}, local_coord_type{},
+                    local_coord_type(top.lower)};
+            m_bounds.upper = {
+                    local_coord_type(m_columns - 1),
+                    local_coord_type(m_rows - 1), local_coord_type(top.upper)};
+            // Allow for rounding in the ray's height across a cell
+            m_pad = std::numeric_limits<float>::epsilon() * 16
+                    * std::max({std::abs(top.lower), std::abs(top.upper),
+                                top.upper - top.lower, 1.0f});
+        }
+
+        /// The number of samples across and down the grid
+        std::size_t columns() const { return m_columns; }
+        std::size_t rows() const { return m_rows; }
+        /// The height of a sample
+        float height(std::size_t const x, std::size_t const y) const {
+            return m_heights[y * m_columns + x];
+        }
+        /// The number of levels used to walk the grid, including the grid
+        /// itself
+        std::size_t levels() const { return m_levels.size() + 1; }
+        /// The extents of the terrain
+        extents3d<local_coord_type> bounds() const { return m_bounds; }
+
+        /// Calculate the intersection point
+        template<typename R, typename E>
+        std::optional<intersection_type>
+                intersects(R const &by, const E epsilon) const {
+            auto const ray = mesh<I, D>::cast(by);
+            local_coord_type limit = std::numeric_limits<D>::max();
+            std::optional<strike> nearest;
+            walk(ray, limit, [&](auto const &s) {
+                if (s.t < limit) {
+                    limit = s.t;
+                    nearest = s;
+                }
+                return false;
+            }, epsilon);
+            if (not nearest) { return {}; }
+
+            auto normal = nearest->normal;
+            if (detail::mesh_dot(normal, ray.direction) >= local_coord_type{}) {
+                normal = {-normal[0], -normal[1], -normal[2]};
+            }
+            return intersection_type(
+                    by.from + by.direction * nearest->t,
+                    typename intersection_type::direction_type(
+                            point3d<local_coord_type>(
+                                    normal[0], normal[1], normal[2])));
+        }
+
+        /// Returns true if the ray hits the terrain
+        template<typename R, typename E>
+        bool occludes(R const &by, const E epsilon) const {
+            auto const ray = mesh<I, D>::cast(by);
+            auto limit = std::numeric_limits<D>::max();
+            return walk(ray, limit, [](auto const &) { return true; }, epsilon);
+        }
+
+      private:
+        using cast_type = typename mesh<I, D>::cast_type;
+        using vertex_type = std::array<local_coord_type, 3>;
+        struct height_range {
+            float lower, upper;
+        };
+        struct strike {
+            local_coord_type t;
+            vertex_type normal;
+        };
+
+        std::size_t m_columns, m_rows;
+        std::vector<float> m_heights;
+        /// The pyramid starting with the level that covers two by two cells
+        std::vector<std::vector<height_range>> m_levels;
+        extents3d<local_coord_type> m_bounds;
+        float m_pad;
+
+        /// The number of cells across (`axis` 0) or down (`axis` 1) at a
+        /// level. Level 0 is the grid itself
+        std::size_t
+                cells(std::size_t const level, std::size_t const axis) const {
+            auto const grid = (axis ? m_rows : m_columns) - 1;
+            return ((grid - 1) >> level) + 1;
+        }
+        /// The heights found within a cell
+        height_range range(
+                std::size_t const level,
+                std::size_t const x,
+                std::size_t const y) const {
+            if (level) {
+                return m_levels[level - 1][y * cells(level, 0) + x];
+            } else {
+                auto const h00 = height(x, y), h10 = height(x + 1, y),
+                           h01 = height(x, y + 1), h11 = height(x + 1, y + 1);
+                return {std::min({h00, h10, h01, h11}),
+                        std::max({h00, h10, h01, h11})};
+            }
+        }
+
+        /// Call `found` with each triangle the ray hits, in about the order
+        /// that they are hit, until it returns true or the hits are past
+        /// `limit`. `limit` may be lowered by `found`
+        template<typename F, typename E>
+        bool walk(
+                cast_type const &ray,
+                local_coord_type const &limit,
+                F const &found,
+                E const epsilon) const {
+            // Clip the ray to the bounds of the terrain
+            local_coord_type t0{}, t1 = limit;
+            for (std::size_t a{}; a != 3; ++a) {
+                if (ray.direction[a] == local_coord_type{}) {
+                    if (ray.from[a] < m_bounds.lower[a]
+                        or ray.from[a] > m_bounds.upper[a]) {
+                        return false;
+                    }
+                } else {
+                    auto near = (m_bounds.lower[a] - ray.from[a])
+                            * ray.inverse[a];
+                    auto far = (m_bounds.upper[a] - ray.from[a])
+                            * ray.inverse[a];
+                    if (near > far) { std::swap(near, far); }
+                    t0 = std::max(t0, near);
+                    t1 = std::min(t1, far);
+                }
+            }
+            if (t0 > t1) { return false; }
+            return dda(levels() - 1, {0, 0, 0, 0}, t0, t1, ray, limit, found,
+                       epsilon);
+        }
+
+        /// Walk across the cells of a level between `first` and `last`
+        /// (inclusive) that the ray passes over between `t0` and `t1`. This
+        /// is a 2D DDA, stepping to whichever cell boundary is closest
+        template<typename F, typename E>
+        bool
+                dda(std::size_t const level,
+                    std::array<std::size_t, 4> const area,
+                    local_coord_type const t0,
+                    local_coord_type const t1,
+                    cast_type const &ray,
+                    local_coord_type const &limit,
+                    F const &found,
+                    E const epsilon) const {
+            auto const size = local_coord_type(std::size_t(1) << level);
+            std::array<std::size_t, 2> cell;
+            std::array<local_coord_type, 2> next, delta;
+            std::array<int, 2> step;
+            for (std::size_t a{}; a != 2; ++a) {
+                auto const at = std::floor(
+                        (ray.from[a] + ray.direction[a] * t0) / size);
+                auto const lowest = area[a], highest = area[a + 2];
+                cell[a] = at <= local_coord_type(lowest) ? lowest
+                        : at >= local_coord_type(highest)
+                        ? highest
+                        : std::size_t(at);
+                if (ray.direction[a] > local_coord_type{}) {
+                    step[a] = 1;
+                    next[a] = (local_coord_type(cell[a] + 1) * size
+                               - ray.from[a])
+                            * ray.inverse[a];
+                    delta[a] = size * ray.inverse[a];
+                } else if (ray.direction[a] < local_coord_type{}) {
+                    step[a] = -1;
+                    next[a] = (local_coord_type(cell[a]) * size - ray.from[a])
+                            * ray.inverse[a];
+                    delta[a] = -size * ray.inverse[a];
+                } else {
+                    step[a] = 0;
+                    next[a] = std::numeric_limits<local_coord_type>::max();
+                    delta[a] = {};
+                }
+            }
+
+            auto enter = t0;
+            while (enter <= limit) {
+                auto const exit = std::min({next[0], next[1], t1});
+                auto const z0 = ray.from[2] + ray.direction[2] * enter,
+                           z1 = ray.from[2] + ray.direction[2] * exit;
+                auto const r = range(level, cell[0], cell[1]);
+                if (std::max(z0, z1) + m_pad >= r.lower
+                    and std::min(z0, z1) - m_pad <= r.upper) {
+                    if (level == 0) {
+                        if (triangles(cell[0], cell[1], ray, found, epsilon)) {
+                            return true;
+                        }
+                    } else {
+                        std::array<std::size_t, 4> const below{
+                                2 * cell[0], 2 * cell[1],
+                                std::min(
+                                        2 * cell[0] + 1,
+                                        cells(level - 1, 0) - 1),
+                                std::min(
+                                        2 * cell[1] + 1,
+                                        cells(level - 1, 1) - 1)};
+                        if (dda(level - 1, below, enter, exit, ray, limit,
+                                found, epsilon)) {
+                            return true;
+                        }
+                    }
+                }
+                if (exit >= t1) { return false; }
+
+                auto const a = next[0] < next[1] ? 0u : 1u;
+                if ((step[a] < 0 and cell[a] == area[a])
+                    or (step[a] > 0 and cell[a] == area[a + 2])) {
+                    return false;
+                }
+                cell[a] += step[a];
+                enter = next[a];
+                next[a] += delta[a];
+            }
+            return false;
+        }
+
+        /// Test the two triangles of a grid cell
+        template<typename F, typename E>
+        bool triangles(
+                std::size_t const x,
+                std::size_t const y,
+                cast_type const &ray,
+                F const &found,
+                E const epsilon) const {
+            auto const corner = [&](std::size_t const cx,
+                                    std::size_t const cy) {
+                return vertex_type{
+                        local_coord_type(cx), local_coord_type(cy),
+                        local_coord_type(height(cx, cy))};
+            };
+            auto const p00 = corner(x, y), p10 = corner(x + 1, y),
+                       p11 = corner(x + 1, y + 1), p01 = corner(x, y + 1);
+            auto const n00 = slope(x, y), n10 = slope(x + 1, y),
+                       n11 = slope(x + 1, y + 1), n01 = slope(x, y + 1);
+            if (auto const s = hit(p00, p10, p11, n00, n10, n11, ray, epsilon);
+                s and found(*s)) {
+                return true;
+            }
+            if (auto const s = hit(p00, p11, p01, n00, n11, n01, ray, epsilon);
+                s and found(*s)) {
+                return true;
+            }
+            return false;
+        }
+
+        /// The normal at a sample worked out from the heights around it
+        vertex_type slope(std::size_t const x, std::size_t const y) const {
+            auto const left = x ? x - 1 : x,
+                       right = std::min(x + 1, m_columns - 1);
+            auto const down = y ? y - 1 : y,
+                       up = std::min(y + 1, m_rows - 1);
+            return {local_coord_type(height(left, y) - height(right, y))
+                            / local_coord_type(right - left),
+                    local_coord_type(height(x, down) - height(x, up))
+                            / local_coord_type(up - down),
+                    local_coord_type(1)};
+        }
+
+        template<typename E>
+        std::optional<strike>
+                hit(vertex_type const &p0,
+                    vertex_type const &p1,
+                    vertex_type const &p2,
+                    vertex_type const &n0,
+                    vertex_type const &n1,
+                    vertex_type const &n2,
+                    cast_type const &by,
+                    E const epsilon) const {
+            if (auto const s = detail::strike_triangle(
+                        p0, p1, p2, by.from, by.direction, epsilon)) {
+                auto const u = s->u, v = s->v;
+                auto const w = local_coord_type(1) - u - v;
+                return strike{
+                        s->t,
+                        {w * n0[0] + u * n1[0] + v * n2[0],
+                         w * n0[1] + u * n1[1] + v * n2[1],
+                         w * n0[2] + u * n1[2] + v * n2[2]}};
+            } else {
+                return {};
+            }
+        }
+    };
+
+
+}
@@ -0,0 +1,170 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/extents3d.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace animray {
+
+
+    /**
+     * # Mesh encodings
+     *
+     * These control how a mesh stores its vertex positions and normals. An
+     * encoding is made from the extents of the positions it will hold and
+     * turns values to and from the `stored_type` kept in the mesh's buffers.
+     * The `encoding` number is saved in mesh caches so that a cache can only
+     * be loaded into a mesh that stores the same way.
+     */
+
+
+    /// Positions stored exactly as given
+    template<typename D>
+    struct exact_positions {
+        using value_type = std::array<D, 3>;
+        using stored_type = value_type;
+        static constexpr std::uint64_t encoding = 0;
+
+        exact_positions() = default;
+        explicit exact_positions(extents3d<D> const &) {}
+
+        /// Nothing is needed to decode positions
+        extents3d<D> range() const { return {}; }
+
+        stored_type encode(value_type const &v) const { return v; }
+        value_type decode(stored_type const &s) const { return s; }
+    };
+
+
+    /// Positions stored as `Bits` bit integers that divide up the extents of
+    /// the mesh. Up to 16 bits are stored in three 16 bit values and up to
+    /// 21 bits are packed into a single 64 bit value.
+    template<typename D, std::size_t Bits>
+    struct quantised_positions {
+        static_assert(Bits > 1 and Bits <= 21);
+        using value_type = std::array<D, 3>;
+        using stored_type = std::conditional_t<
+                (Bits <= 16), std::array<std::uint16_t, 3>, std::uint64_t>;
+        static constexpr std::uint64_t encoding = Bits;
+        /// The largest stored value
+        static constexpr std::uint32_t top = (1u << Bits) - 1u;
+
+        quantised_positions() = default;
+        explicit quantised_positions(extents3d<D> const &r) : m_range{r} {
+            for (std::size_t a{}; a != 3; ++a) {
+                auto const size = r.upper[a] - r.lower[a];
+                m_step[a] = size > D{} ? size / D(top) : D{};
+                m_scale[a] = size > D{} ? D(top) / size : D{};
+            }
+        }
+
+        /// The extents that are divided up
+        extents3d<D> range() const { return m_range; }
+
+        stored_type encode(value_type const &v) const {
+            std::array<std::uint32_t, 3> q;
+            for (std::size_t a{}; a != 3; ++a) {
+                auto const scaled =
+                        std::round((v[a] - m_range.lower[a]) * m_scale[a]);
+                q[a] = scaled <= D{} ? 0u
+                        : scaled >= D(top) ? top
+                                           : std::uint32_t(scaled);
+            }
+            if constexpr (Bits <= 16) {
+                return {std::uint16_t(q[0]), std::uint16_t(q[1]),
+                        std::uint16_t(q[2])};
+            } else {
+                return std::uint64_t(q[0]) | (std::uint64_t(q[1]) << Bits)
+                        | (std::uint64_t(q[2]) << (2 * Bits));
+            }
+        }
+        value_type decode(stored_type const &s) const {
+            if constexpr (Bits <= 16) {
+                return {m_range.lower[0] + D(s[0]) * m_step[0],
+                        m_range.lower[1] + D(s[1]) * m_step[1],
+                        m_range.lower[2] + D(s[2]) * m_step[2]};
+            } else {
+                return {m_range.lower[0] + D(s & top) * m_step[0],
+                        m_range.lower[1] + D((s >> Bits) & top) * m_step[1],
+                        m_range.lower[2]
+                                + D((s >> (2 * Bits)) & top) * m_step[2]};
+            }
+        }
+
+      private:
+        extents3d<D> m_range = {};
+        std::array<D, 3> m_step = {}, m_scale = {};
+    };
+
+
+    /// Normals stored exactly as given
+    template<typename D>
+    using exact_normals = exact_positions<D>;
+
+
+    /// Normals stored as two 16 bit values using an octahedral mapping of
+    /// the unit sphere. Decoded normals are not unit length.
+    template<typename D>
+    struct octahedral_normals {
+        using value_type = std::array<D, 3>;
+        using stored_type = std::array<std::int16_t, 2>;
+        static constexpr std::uint64_t encoding = 1;
+        static constexpr D top = D(32767);
+
+        octahedral_normals() = default;
+        explicit octahedral_normals(extents3d<D> const &) {}
+
+        stored_type encode(value_type const &n) const {
+            auto const length =
+                    std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+            if (length <= D{}) { return {}; }
+            D x = n[0] / length, y = n[1] / length;
+            if (n[2] < D{}) {
+                auto const ox = x;
+                x = (D(1) - std::abs(y)) * sign(ox);
+                y = (D(1) - std::abs(ox)) * sign(y);
+            }
+            return {std::int16_t(std::round(x * top)),
+                    std::int16_t(std::round(y * top))};
+        }
+        value_type decode(stored_type const &s) const {
+            D x = D(s[0]) / top, y = D(s[1]) / top;
+            D const z = D(1) - std::abs(x) - std::abs(y);
+            if (z < D{}) {
+                auto const ox = x;
+                x = (D(1) - std::abs(y)) * sign(ox);
+                y = (D(1) - std::abs(ox)) * sign(y);
+            }
+            return {x, y, z};
+        }
+
+      private:
+        static D sign(D const v) { return v < D{} ? D(-1) : D(1); }
+    };
+
+
+}
@@ -0,0 +1,390 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/geometry/bvh.hpp>
+#include <animray/geometry/mesh-encoding.hpp>
+#include <animray/geometry/planar/triangle-strike.hpp>
+#include <animray/mixins/setup.hpp>
+#include <animray/unit-vector.hpp>
+#include <felspar/exceptions/overflow_error.hpp>
+
+#include <memory>
+#include <optional>
+
+
+namespace animray {
+
+
+    /**
+     * # Mesh
+     *
+     * A triangle mesh whose triangles share a single vertex buffer and are
+     * described by three 32 bit indexes into it. If a normal is given for
+     * every vertex then they are interpolated across each triangle for
+     * smooth shading, otherwise the flat triangle normal is used.
+     *
+     * The buffers are only viewed by the mesh so they may belong to it, or
+     * be kept alive by something else (for example a file mapping). Copying
+     * a mesh shares the buffers.
+     *
+     * `V` and `N` are the encodings (see `mesh-encoding.hpp`) used to store
+     * the positions and normals. Smaller encodings let more of a mesh fit in
+     * memory for the cost of decoding the vertices as each triangle is
+     * tested.
+     */
+    template<
+            typename I,
+            typename D = typename I::local_coord_type,
+            typename V = exact_positions<D>,
+            typename N = exact_normals<D>>
+    class mesh {
+      public:
+        /// The type of the local coordinates used
+        using local_coord_type = D;
+        /// Type of intersection to be returned
+        using intersection_type = I;
+        /// The type of the vertex positions
+        using vertex_type = std::array<local_coord_type, 3>;
+        /// The type of the vertex normals
+        using normal_type = std::array<local_coord_type, 3>;
+        /// How the positions are stored
+        using position_encoding_type = V;
+        /// How the normals are stored
+        using normal_encoding_type = N;
+        /// The type of the positions in the vertex buffer
+        using stored_vertex_type = typename V::stored_type;
+        /// The type of the normals in the normal buffer
+        using stored_normal_type = typename N::stored_type;
+        /// Type used for indexing into the vertex buffer
+        using index_type = std::uint32_t;
+        /// The three vertex indexes for a triangle
+        using face_type = std::array<index_type, 3>;
+        /// The type of the spatial index nodes
+        using node_type = bvh_node<local_coord_type>;
+
+        /// An empty mesh
+        mesh() = default;
+
+        /// Build a mesh that owns its buffers. The faces are re-ordered to
+        /// match the spatial index that is built for them.
+        mesh(std::vector<vertex_type> vertices,
+             std::vector<face_type> faces,
+             std::vector<normal_type> normals = {}) {
+            check(vertices.size(), faces, normals.size());
+            extents3d<local_coord_type> range;
+            for (auto const &v : vertices) { range.extend(v); }
+            m_positions = V{range};
+            m_normal_encoding = N{range};
+            auto owned = std::make_shared<buffers>();
+            if constexpr (std::is_same_v<stored_vertex_type, vertex_type>) {
+                owned->vertices = std::move(vertices);
+            } else {
+                owned->vertices.reserve(vertices.size());
+                for (auto const &v : vertices) {
+                    owned->vertices.push_back(m_positions.encode(v));
+                }
+            }
+            if constexpr (std::is_same_v<stored_normal_type, normal_type>) {
+                owned->normals = std::move(normals);
+            } else {
+                owned->normals.reserve(normals.size());
+                for (auto const &n : normals) {
+                    owned->normals.push_back(m_normal_encoding.encode(n));
+                }
+            }
+            m_vertices = owned->vertices;
+            m_normals = owned->normals;
+
+            // The index must be built around the positions as they will be
+            // decoded, not as they were given
+            std::vector<extents3d<local_coord_type>> bounds;
+            bounds.reserve(faces.size());
+            for (auto const &f : faces) {
+                bounds.emplace_back()
+                        .extend(vertex(f[0]))
+                        .extend(vertex(f[1]))
+                        .extend(vertex(f[2]));
+            }
+            std::vector<index_type> order;
+            owned->nodes = build_bvh(bounds, order);
+            owned->faces.reserve(faces.size());
+            for (auto const f : order) { owned->faces.push_back(faces[f]); }
+            m_faces = owned->faces;
+            m_nodes = owned->nodes;
+            m_storage = std::move(owned);
+        }
+
+        /// View buffers that are kept alive by `storage`. The spatial index
+        /// must already have been built for the faces, and `positions` must
+        /// be the encoding the vertices were stored with.
+        mesh(std::span<stored_vertex_type const> vertices,
+             std::span<face_type const> faces,
+             std::span<stored_normal_type const> normals,
+             std::span<node_type const> nodes,
+             std::shared_ptr<void const> storage,
+             V const &positions = {})
+        : m_storage{std::move(storage)},
+          m_vertices{vertices},
+          m_normals{normals},
+          m_faces{faces},
+          m_nodes{nodes},
+          m_positions{positions} {
+            check(vertices.size(), faces, normals.size());
+            check(faces, nodes);
+        }
+
+        /// The shared vertex positions as they're stored
+        std::span<stored_vertex_type const> vertices() const {
+            return m_vertices;
+        }
+        /// The vertex normals as they're stored, empty for a flat shaded mesh
+        std::span<stored_normal_type const> normals() const {
+            return m_normals;
+        }
+        /// The triangles
+        std::span<face_type const> faces() const { return m_faces; }
+        /// The spatial index over the triangles
+        std::span<node_type const> nodes() const { return m_nodes; }
+        /// The encoding of the vertex positions
+        V const &position_encoding() const { return m_positions; }
+
+        /// The position of a vertex
+        vertex_type vertex(std::size_t const v) const {
+            return m_positions.decode(m_vertices[v]);
+        }
+        /// The normal for a vertex
+        normal_type normal(std::size_t const v) const {
+            return m_normal_encoding.decode(m_normals[v]);
+        }
+
+        /// The extents of the whole mesh
+        extents3d<local_coord_type> bounds() const {
+            if (m_nodes.empty()) {
+                return {};
+            } else {
+                return m_nodes.front().bounds;
+            }
+        }
+
+        /// The ray in the form used by the triangle kernel
+        struct cast_type {
+            vertex_type from, direction, inverse;
+        };
+        /// Convert a ray for use with `closest` and `any`
+        template<typename R>
+        static cast_type cast(R const &by) {
+            if constexpr (is_set_up<R>) {
+                return {by.cartesian_from.array(),
+                        by.cartesian_direction.array(), by.inverse};
+            }
+            cast_type r{
+                    {by.from.x(), by.from.y(), by.from.z()},
+                    {by.direction.x(), by.direction.y(), by.direction.z()},
+                    {}};
+            for (std::size_t a{}; a != 3; ++a) {
+                r.inverse[a] = local_coord_type(1) / r.direction[a];
+            }
+            return r;
+        }
+
+        /// Where a ray strikes a triangle
+        struct strike_type {
+            local_coord_type t, u, v;
+            std::uint32_t face;
+            vertex_type normal;
+        };
+        /// The closest triangle hit before `limit`
+        template<typename E>
+        std::optional<strike_type> closest(
+                cast_type const &ray,
+                local_coord_type limit,
+                const E epsilon) const {
+            std::optional<strike_type> nearest;
+            traverse_bvh(
+                    m_nodes, ray.from, ray.inverse, limit,
+                    [&](std::uint32_t const first, std::uint32_t const count) {
+                        for (auto f = first; f != first + count; ++f) {
+                            auto const s = hit(f, ray, epsilon);
+                            if (s and s->t < limit) {
+                                limit = s->t;
+                                nearest = s;
+                            }
+                        }
+                        return false;
+                    });
+            return nearest;
+        }
+        /// True if any triangle is hit before `limit`
+        template<typename E>
+        bool
+                any(cast_type const &ray,
+                    local_coord_type const limit,
+                    const E epsilon) const {
+            return traverse_bvh(
+                    m_nodes, ray.from, ray.inverse, limit,
+                    [&](std::uint32_t const first, std::uint32_t const count) {
+                        for (auto f = first; f != first + count; ++f) {
+                            if (auto const s = hit(f, ray, epsilon);
+                                s and s->t < limit) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    });
+        }
+        /// The intersection for a strike found by `closest`
+        template<typename R>
+        intersection_type intersection(
+                R const &by,
+                cast_type const &ray,
+                strike_type const &strike) const {
+            auto const &face = m_faces[strike.face];
+            vertex_type normal;
+            if (m_normals.empty()) {
+                normal = strike.normal;
+            } else {
+                auto const u = strike.u, v = strike.v,
+                           w = local_coord_type(1) - u - v;
+                auto const n0 = this->normal(face[0]),
+                           n1 = this->normal(face[1]),
+                           n2 = this->normal(face[2]);
+                for (std::size_t a{}; a != 3; ++a) {
+                    normal[a] = w * n0[a] + u * n1[a] + v * n2[a];
+                }
+            }
+            if (detail::mesh_dot(normal, ray.direction) >= local_coord_type{}) {
+                normal = {-normal[0], -normal[1], -normal[2]};
+            }
+            return intersection_type(
+                    by.from + by.direction * strike.t,
+                    typename intersection_type::direction_type(
+                            point3d<local_coord_type>(
+                                    normal[0], normal[1], normal[2])));
+        }
+
+        /// Calculate the intersection point
+        template<typename R, typename E>
+        std::optional<intersection_type>
+                intersects(R const &by, const E epsilon) const {
+            auto const ray = cast(by);
+            if (auto const s = closest(
+                        ray, std::numeric_limits<local_coord_type>::max(),
+                        epsilon)) {
+                return intersection(by, ray, *s);
+            } else {
+                return {};
+            }
+        }
+
+        /// Returns true if the ray hits any of the triangles
+        template<typename R, typename E>
+        bool occludes(R const &by, const E epsilon) const {
+            return any(
+                    cast(by), std::numeric_limits<local_coord_type>::max(),
+                    epsilon);
+        }
+
+      private:
+        struct buffers {
+            std::vector<stored_vertex_type> vertices;
+            std::vector<stored_normal_type> normals;
+            std::vector<face_type> faces;
+            std::vector<node_type> nodes;
+        };
+        std::shared_ptr<void const> m_storage;
+        std::span<stored_vertex_type const> m_vertices;
+        std::span<stored_normal_type const> m_normals;
+        std::span<face_type const> m_faces;
+        std::span<node_type const> m_nodes;
+        V m_positions = {};
+        N m_normal_encoding = {};
+
+        static void
+                check(std::size_t const vertices,
+                      std::span<face_type const> faces,
+                      std::size_t const normals) {
+            if (normals and normals != vertices) {
+                throw felspar::overflow_error{
+                        "There must be a normal for every vertex", normals,
+                        vertices};
+            }
+            for (auto const &f : faces) {
+                for (auto const v : f) {
+                    if (v >= vertices) {
+                        throw felspar::overflow_error{
+                                "Mesh vertex index is out of range",
+                                std::size_t(v), vertices};
+                    }
+                }
+            }
+        }
+
+        /// Check that the spatial index can be walked safely
+        static void
+                check(std::span<face_type const> faces,
+                      std::span<node_type const> nodes) {
+            std::vector<std::uint8_t> depth(nodes.size());
+            for (std::size_t n{}; n != nodes.size(); ++n) {
+                auto const &node = nodes[n];
+                if (node.leaf()) {
+                    if (node.offset > faces.size()
+                        or node.count > faces.size() - node.offset) {
+                        throw felspar::overflow_error{
+                                "Mesh index leaf is past the last face",
+                                std::size_t(node.offset) + node.count,
+                                faces.size()};
+                    }
+                } else if (
+                        node.offset <= n + 1 or node.offset >= nodes.size()
+                        or node.axis > 2) {
+                    throw felspar::overflow_error{
+                            "Mesh index node has a bad child",
+                            std::size_t(node.offset), nodes.size()};
+                } else if (depth[n] >= 62) {
+                    throw felspar::overflow_error{
+                            "Mesh index is too deep", std::size_t(depth[n]),
+                            std::size_t(62)};
+                } else {
+                    depth[n + 1] = depth[node.offset] = depth[n] + 1;
+                }
+            }
+        }
+
+        template<typename E>
+        std::optional<strike_type> hit(
+                std::uint32_t const f,
+                cast_type const &by,
+                E const epsilon) const {
+            auto const &face = m_faces[f];
+            if (auto const s = detail::strike_triangle(
+                        vertex(face[0]), vertex(face[1]), vertex(face[2]),
+                        by.from, by.direction, epsilon)) {
+                return strike_type{s->t, s->u, s->v, f, s->normal};
+            } else {
+                return {};
+            }
+        }
+    };
+
+
+}
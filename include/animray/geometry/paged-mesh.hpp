@@ -0,0 +1,321 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/formats/brick-file.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+
+namespace animray {
+
+
+    /**
+     * ## Brick cache
+     *
+     * Keeps the most recently used bricks of a brick file in memory, up to
+     * a fixed number of bytes. Bricks are pinned while they're being used
+     * and pinned bricks are never evicted.
+     *
+     * Finding a brick that is already in memory only touches atomics in
+     * that brick's own entry. The mutex is only taken when a brick has to be
+     * read from disk, and the read itself happens without holding it.
+     */
+    template<typename M>
+    class brick_cache {
+        using file_type = brick_file<typename M::local_coord_type>;
+
+        struct entry {
+            std::atomic<M const *> mesh{};
+            std::atomic<std::uint32_t> pins{};
+            std::atomic<std::uint64_t> used{};
+            /// Owns the mesh when it is loaded. Guarded by the mutex
+            std::unique_ptr<M const> owned;
+            bool loading = false;
+        };
+
+        file_type m_file;
+        std::size_t const m_capacity;
+        std::vector<entry> m_entries;
+        /// Counts misses and is used to order the entries by their last use
+        std::atomic<std::uint64_t> m_clock{1};
+
+        std::mutex m_mutex;
+        std::condition_variable m_loaded;
+        std::vector<std::size_t> m_resident;
+        std::size_t m_bytes{};
+
+      public:
+        /// The type of the bricks
+        using mesh_type = M;
+
+        /// Page bricks in from the file keeping up to `capacity` bytes of
+        /// them in memory
+        brick_cache(
+                std::filesystem::path const &filename,
+                std::size_t const capacity)
+        : m_file{filename},
+          m_capacity{capacity},
+          m_entries(m_file.bricks().size()) {}
+
+        /// The bricks that can be paged in
+        auto bricks() const { return m_file.bricks(); }
+
+        /// A brick that is kept in memory for as long as this is alive
+        class pinned {
+            friend class brick_cache;
+            brick_cache *cache;
+            std::size_t index;
+            M const *brick;
+
+            pinned(brick_cache *c, std::size_t i, M const *b)
+            : cache{c}, index{i}, brick{b} {}
+
+          public:
+            pinned(pinned const &) = delete;
+            pinned &operator=(pinned const &) = delete;
+            ~pinned() {
+                cache->m_entries[index].pins.fetch_sub(
+                        1, std::memory_order_release);
+            }
+
+            M const &operator*() const { return *brick; }
+            M const *operator->() const { return brick; }
+        };
+
+        /// Fetch a brick, reading it from disk if it isn't in memory
+        pinned operator[](std::size_t const index) {
+            auto &e = m_entries[index];
+            e.pins.fetch_add(1);
+            if (auto const brick = e.mesh.load()) {
+                touch(e);
+                return {this, index, brick};
+            }
+            e.pins.fetch_sub(1);
+            return {this, index, load(index)};
+        }
+
+        /// The number of bytes of bricks held in memory
+        std::size_t resident() {
+            std::scoped_lock lock{m_mutex};
+            return m_bytes;
+        }
+        /// The number of times a brick has been read from disk
+        std::uint64_t misses() const { return m_clock.load() - 1; }
+
+      private:
+        void touch(entry &e) {
+            // Only write to the entry when it changes to save the cache
+            // line from bouncing between threads
+            auto const now = m_clock.load(std::memory_order_relaxed);
+            if (e.used.load(std::memory_order_relaxed) != now) {
+                e.used.store(now, std::memory_order_relaxed);
+            }
+        }
+
+        M const *load(std::size_t const index) {
+            auto &e = m_entries[index];
+            std::unique_lock lock{m_mutex};
+            while (true) {
+                e.pins.fetch_add(1);
+                if (auto const brick = e.mesh.load()) {
+                    touch(e);
+                    return brick;
+                }
+                e.pins.fetch_sub(1);
+                if (not e.loading) { break; }
+                m_loaded.wait(lock);
+            }
+            e.loading = true;
+            lock.unlock();
+            std::unique_ptr<M const> brick;
+            try {
+                brick = std::make_unique<M const>(
+                        m_file.template mesh<M>(index));
+            } catch (...) {
+                lock.lock();
+                e.loading = false;
+                m_loaded.notify_all();
+                throw;
+            }
+            lock.lock();
+
+            auto const size = m_file.bricks()[index].size;
+            while (m_bytes + size > m_capacity and evict()) {}
+            auto const pointer = brick.get();
+            e.owned = std::move(brick);
+            e.pins.fetch_add(1);
+            e.used.store(++m_clock);
+            e.mesh.store(pointer);
+            e.loading = false;
+            m_resident.push_back(index);
+            m_bytes += size;
+            m_loaded.notify_all();
+            return pointer;
+        }
+
+        /// Evict the least recently used brick that isn't pinned. Must be
+        /// called with the mutex held
+        bool evict() {
+            auto const age = [this](std::size_t const index) {
+                auto const &e = m_entries[index];
+                return e.pins.load(std::memory_order_relaxed)
+                        ? std::numeric_limits<std::uint64_t>::max()
+                        : e.used.load(std::memory_order_relaxed);
+            };
+            // A brick that gets pinned while it is being evicted is put
+            // back and another tried, but only so many times
+            for (std::size_t tries{}; tries != m_resident.size(); ++tries) {
+                auto const oldest = std::min_element(
+                        m_resident.begin(), m_resident.end(),
+                        [&](auto const l, auto const r) {
+                            return age(l) < age(r);
+                        });
+                if (oldest == m_resident.end()) { return false; }
+                auto const index = *oldest;
+                auto &e = m_entries[index];
+                if (e.pins.load()) { return false; }
+                // Remove the brick and then check that nobody pinned it
+                // before it went. Anybody pinning it afterwards will see it
+                // has gone and wait on the mutex
+                auto const brick = e.mesh.exchange(nullptr);
+                if (e.pins.load()) {
+                    e.mesh.store(brick);
+                    continue;
+                }
+                e.owned.reset();
+                *oldest = m_resident.back();
+                m_resident.pop_back();
+                m_bytes -= m_file.bricks()[index].size;
+                return true;
+            }
+            return false;
+        }
+    };
+
+
+    /**
+     * # Paged mesh
+     *
+     * A mesh that is too big to keep in memory. It is stored in a brick file
+     * (see `save_bricks`) and the bricks that rays reach are paged in through
+     * a shared cache of a fixed size. Only the bounds of the bricks are kept
+     * in memory all of the time, together with an index over them.
+     *
+     * Copies share the cache so the same paged mesh can be given to all of
+     * the rendering threads. The bricks store their vertices using the
+     * encodings `V` and `N`, each relative to the brick's own bounds.
+     */
+    template<
+            typename I,
+            typename D = typename I::local_coord_type,
+            typename V = exact_positions<D>,
+            typename N = exact_normals<D>>
+    class paged_mesh {
+      public:
+        /// The type of the local coordinates used
+        using local_coord_type = D;
+        /// Type of intersection to be returned
+        using intersection_type = I;
+        /// The type of each brick
+        using mesh_type = mesh<intersection_type, local_coord_type, V, N>;
+        /// The cache the bricks are paged in to
+        using cache_type = brick_cache<mesh_type>;
+
+        /// Page the mesh in from the brick file keeping up to `capacity`
+        /// bytes of bricks in memory
+        paged_mesh(
+                std::filesystem::path const &filename,
+                std::size_t const capacity)
+        : m_cache{std::make_shared<cache_type>(filename, capacity)} {
+            std::vector<extents3d<local_coord_type>> bounds;
+            for (auto const &b : m_cache->bricks()) {
+                bounds.push_back(b.bounds);
+            }
+            m_nodes = build_bvh(bounds, m_order, 1);
+        }
+
+        /// The cache of bricks
+        cache_type &cache() const { return *m_cache; }
+
+        /// The extents of the whole mesh
+        extents3d<local_coord_type> bounds() const {
+            if (m_nodes.empty()) {
+                return {};
+            } else {
+                return m_nodes.front().bounds;
+            }
+        }
+
+        /// Calculate the intersection point
+        template<typename R, typename E>
+        std::optional<intersection_type>
+                intersects(R const &by, const E epsilon) const {
+            auto const ray = mesh_type::cast(by);
+            local_coord_type limit = std::numeric_limits<D>::max();
+            std::optional<intersection_type> nearest;
+            traverse_bvh<local_coord_type>(
+                    m_nodes, ray.from, ray.inverse, limit,
+                    [&](std::uint32_t const first, std::uint32_t const count) {
+                        for (auto b = first; b != first + count; ++b) {
+                            auto const brick = (*m_cache)[m_order[b]];
+                            if (auto const s =
+                                        brick->closest(ray, limit, epsilon)) {
+                                limit = s->t;
+                                nearest = brick->intersection(by, ray, *s);
+                            }
+                        }
+                        return false;
+                    });
+            return nearest;
+        }
+
+        /// Returns true if the ray hits any of the triangles
+        template<typename R, typename E>
+        bool occludes(R const &by, const E epsilon) const {
+            auto const ray = mesh_type::cast(by);
+            auto const limit = std::numeric_limits<local_coord_type>::max();
+            return traverse_bvh<local_coord_type>(
+                    m_nodes, ray.from, ray.inverse, limit,
+                    [&](std::uint32_t const first, std::uint32_t const count) {
+                        for (auto b = first; b != first + count; ++b) {
+                            if ((*m_cache)[m_order[b]]->any(
+                                        ray, limit, epsilon)) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    });
+        }
+
+      private:
+        std::shared_ptr<cache_type> m_cache;
+        std::vector<std::uint32_t> m_order;
+        std::vector<bvh_node<local_coord_type>> m_nodes;
+    };
+
+
+}
@@ -0,0 +1,97 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <array>
+#include <optional>
+
+
+namespace animray {
+
+
+    namespace detail {
+        template<typename D>
+        inline std::array<D, 3> mesh_minus(
+                std::array<D, 3> const &l, std::array<D, 3> const &r) {
+            return {l[0] - r[0], l[1] - r[1], l[2] - r[2]};
+        }
+        template<typename D>
+        inline D
+                mesh_dot(std::array<D, 3> const &l, std::array<D, 3> const &r) {
+            return l[0] * r[0] + l[1] * r[1] + l[2] * r[2];
+        }
+        template<typename D>
+        inline std::array<D, 3> mesh_cross(
+                std::array<D, 3> const &b, std::array<D, 3> const &c) {
+            return {b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2],
+                    b[0] * c[1] - b[1] * c[0]};
+        }
+
+
+        /// Where a ray strikes a triangle. `u` and `v` are the barycentric
+        /// co-ordinates of the second and third corners, and `normal` is
+        /// the (not normalised) normal on the side the corners wind
+        /// clockwise
+        template<typename D>
+        struct triangle_strike {
+            D t, u, v;
+            std::array<D, 3> normal;
+        };
+
+
+        /// The Möller–Trumbore intersection algorithm, shared by all of the
+        /// triangle based geometry
+        template<typename D, typename E>
+        inline std::optional<triangle_strike<D>> strike_triangle(
+                std::array<D, 3> const &p0,
+                std::array<D, 3> const &p1,
+                std::array<D, 3> const &p2,
+                std::array<D, 3> const &from,
+                std::array<D, 3> const &direction,
+                E const epsilon) {
+            auto const e1 = mesh_minus(p1, p0);
+            auto const e2 = mesh_minus(p2, p0);
+
+            auto const P = mesh_cross(direction, e2);
+            auto const determinant = mesh_dot(e1, P);
+            if (determinant > -epsilon && determinant < epsilon) { return {}; }
+            auto const inv_determinant = D(1) / determinant;
+
+            auto const T = mesh_minus(from, p0);
+            auto const u = mesh_dot(T, P) * inv_determinant;
+            if (u < D() || u > D(1)) { return {}; }
+
+            auto const Q = mesh_cross(T, e1);
+            auto const v = mesh_dot(direction, Q) * inv_determinant;
+            if (v < D() || u + v > D(1)) { return {}; }
+
+            auto const t = mesh_dot(e2, Q) * inv_determinant;
+            if (t > epsilon) {
+                return triangle_strike<D>{t, u, v, mesh_cross(e2, e1)};
+            } else {
+                return {};
+            }
+        }
+    }
+
+
+}
@@ -23,16 +23,21 @@
 #pragma once
 
 
-#include <animray/maths/cross.hpp>
+#include <animray/affine-matrix.hpp>
+#include <animray/geometry/planar/triangle-strike.hpp>
 #include <animray/maths/dot.hpp>
+#include <animray/mixins/setup.hpp>
+
+#include <optional>
+#include <utility>
 
 
 namespace animray {
 
 
     template<typename I, typename D = typename I::local_coord_type>
-    class triangle : private detail::array_based<point3d<D>, 3> {
-        typedef detail::array_based<point3d<D>, 3> superclass;
+    class triangle : private detail::array_based<cartesian3d<D>, 3> {
+        typedef detail::array_based<cartesian3d<D>, 3> superclass;
 
       public:
         /// The type of the local coordinates used
@@ -44,49 +49,48 @@ namespace animray {
 
         /// Construct a triangle from three points
         constexpr triangle(
-                corner_type one, corner_type two, corner_type three) noexcept {
-            superclass::array[0] = std::move(one);
-            superclass::array[1] = std::move(two);
-            superclass::array[2] = std::move(three);
+                corner_type const &one,
+                corner_type const &two,
+                corner_type const &three) noexcept {
+            superclass::array[0] = cartesian3d<local_coord_type>{one};
+            superclass::array[1] = cartesian3d<local_coord_type>{two};
+            superclass::array[2] = cartesian3d<local_coord_type>{three};
+        }
+        /// Construct a triangle from three Cartesian points
+        constexpr triangle(
+                cartesian3d<local_coord_type> const &one,
+                cartesian3d<local_coord_type> const &two,
+                cartesian3d<local_coord_type> const &three) noexcept {
+            superclass::array[0] = one;
+            superclass::array[1] = two;
+            superclass::array[2] = three;
         }
 
+        /// The corners of the triangle
+        constexpr auto const &corners() const { return superclass::array; }
+
         /// Calculate the intersection point
         template<typename R, typename E>
         std::optional<intersection_type>
-                intersects(R by, const E epsilon) const {
-            // Möller–Trumbore intersection algorithm
-            const corner_type e1(superclass::array[1] - superclass::array[0]);
-            const corner_type e2(superclass::array[2] - superclass::array[0]);
-
-            const corner_type P(cross(by.direction, e2));
-            const local_coord_type determinant(dot(e1, P));
-            if (determinant > -epsilon && determinant < epsilon) { return {}; }
-            const local_coord_type inv_determinant(
-                    local_coord_type(1) / determinant);
-
-            const corner_type T(by.from - superclass::array[0]);
-            const local_coord_type u(dot(T, P) * inv_determinant);
-            if (u < local_coord_type() || u > local_coord_type(1)) {
-                return {};
-            }
-
-            const corner_type Q(cross(T, e1));
-            const local_coord_type v(dot(by.direction, Q) * inv_determinant);
-            if (v < local_coord_type() || u + v > local_coord_type(1)) {
-                return {};
-            }
-
-            const local_coord_type t(dot(e2, Q) * inv_determinant);
-            if (t > epsilon) {
-                typename intersection_type::direction_type normal(
-                        cross(e2, e1));
-                if (dot(normal, by.direction) < local_coord_type{}) {
-                    return intersection_type(
-                            by.from + by.direction * t, normal);
-                } else {
-                    return intersection_type(
-                            by.from + by.direction * t, -normal);
-                }
+                intersects(R const &by, const E epsilon) const {
+            auto const &from = cartesian_from(by);
+            auto const &direction = cartesian_direction(by);
+            auto const &c = superclass::array;
+            if (auto const s = detail::strike_triangle(
+                        c[0].array(), c[1].array(), c[2].array(),
+                        from.array(), direction.array(), epsilon)) {
+                using end_type = typename intersection_type::end_type;
+                using direction_type =
+                        typename intersection_type::direction_type;
+                auto const &n = s->normal;
+                direction3d<local_coord_type> const normal(
+                        cartesian3d<local_coord_type>{n[0], n[1], n[2]});
+                return intersection_type(
+                        end_type(from + direction * s->t),
+                        direction_type(
+                                dot(normal, direction) < local_coord_type{}
+                                        ? normal
+                                        : -normal));
             } else {
                 return {};
             }
@@ -94,12 +98,22 @@ namespace animray {
 
         /// Returns true if the ray hits the triangle
         template<typename R, typename E>
-        bool occludes(R by, const E epsilon) const {
+        bool occludes(R const &by, const E epsilon) const {
             return intersects(by, epsilon).has_value();
         }
     };
 
 
+    /// Bake a transformation into the corners of the triangle
+    template<typename I, typename D>
+    triangle<I, D>
+            bake(triangle<I, D> const &t,
+                 std::pair<affine_matrix<D>, affine_matrix<D>> const &m) {
+        auto const &c = t.corners();
+        return {m.first * c[0], m.first * c[1], m.first * c[2]};
+    }
+
+
 }
 
 
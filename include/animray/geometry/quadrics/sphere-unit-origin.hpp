@@ -26,6 +26,7 @@
 #include <animray/epsilon.hpp>
 #include <animray/ray.hpp>
 #include <animray/maths/dot.hpp>
+#include <animray/mixins/setup.hpp>
 #include <animray/maths/quadratic.hpp>
 
 
@@ -48,8 +49,22 @@ namespace animray {
         /// Returns the b c values for the quadratic given a start and direction
         template<typename R>
         static std::pair<D, D> quadratic_b_c(const R &by) {
-            return std::make_pair(
-                    D{2} * dot(by.from, by.direction), by.from.dot() - D{1});
+            return quadratic_b_c(
+                    by, cartesian_from(by), cartesian_direction(by));
+        }
+        /// As above, where the Cartesian start and direction are known
+        template<typename R>
+        static std::pair<D, D> quadratic_b_c(
+                R const &by,
+                cartesian3d<D> const &from,
+                direction3d<D> const &direction) {
+            if constexpr (is_set_up<R>) {
+                return std::make_pair(
+                        D{2} * by.from_dot_direction, by.from_dot_from - D{1});
+            } else {
+                return std::make_pair(
+                        D{2} * dot(from, direction), from.dot() - D{1});
+            }
         }
 
         /// Returns a ray giving the intersection point and surface normal or
@@ -57,14 +72,19 @@ namespace animray {
         template<typename R>
         std::optional<intersection_type>
                 intersects(const R &by, D const eps = epsilon<D>) const {
-            const std::pair<D, D> bc(quadratic_b_c(by));
-            const std::optional<D> t(first_positive_quadratic_solution(
-                    D(1), bc.first, bc.second, eps));
+            auto const &from = cartesian_from(by);
+            auto const &direction = cartesian_direction(by);
+            auto const [b, c] = quadratic_b_c(by, from, direction);
+            const std::optional<D> t(
+                    first_positive_quadratic_solution(D(1), b, c, eps));
             if (t) {
-                using end_type = typename ray<D>::end_type;
-                using direction_type = typename ray<D>::direction_type;
-                direction_type normal(by.from + by.direction * *t);
-                return intersection_type(end_type(normal), normal);
+                using end_type = typename intersection_type::end_type;
+                using direction_type =
+                        typename intersection_type::direction_type;
+                auto const hit = from + direction * *t;
+                return intersection_type(
+                        end_type(hit),
+                        direction_type(direction3d<D>{hit}));
             } else {
                 return {};
             }
@@ -0,0 +1,282 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/affine.hpp>
+#include <animray/epsilon.hpp>
+#include <animray/maths/dot.hpp>
+#include <animray/maths/quadratic.hpp>
+#include <animray/geometry/quadrics/sphere-unit-origin.hpp>
+#include <animray/mixins/setup.hpp>
+#include <animray/ray.hpp>
+
+#include <stdexcept>
+
+
+namespace animray {
+
+
+    /**
+     * # Sphere
+     *
+     * A sphere with a centre and radius that is intersected directly in
+     * the co-ordinate system it is placed in. The default sphere is the
+     * unit sphere at the origin.
+     *
+     * It takes the same translations and scales as a `movable`, but
+     * instead of storing matrices and transforming every ray they are
+     * folded into the centre and radius. This means a
+     * `movable<unit_sphere_at_origin>` that is only translated and scaled
+     * the same along every axis can be swapped for a sphere without
+     * changing how the scene positions it.
+     *
+     * The centre and radius can be stored at a lower precision than the
+     * rays, for example `sphere<ray<double>, float>`. The intersection is
+     * then worked out at the lower precision together with a bound on its
+     * error. Only when the bound means a hit might have been a miss, or
+     * the other way around, is it worked out again at the precision of the
+     * ray. The hits that are certain are refined to the ray's precision.
+     */
+    template<typename I, typename D = typename I::local_coord_type>
+    struct sphere {
+        /// The type of the local coordinates used
+        using local_coord_type = D;
+        /// Type of intersection to return when the sphere is struck
+        using intersection_type = I;
+        /// The type of the centre
+        using centre_type = cartesian3d<local_coord_type>;
+
+        /// The centre of the sphere
+        centre_type centre = {};
+        /// The radius of the sphere
+        local_coord_type radius = local_coord_type{1};
+
+        /// Construct a unit sphere at the origin
+        sphere() = default;
+        /// Construct a sphere at the given centre and radius
+        sphere(centre_type c, local_coord_type const r)
+        : centre{std::move(c)}, radius{r} {}
+
+        /// Check for equality
+        bool operator==(sphere const &s) const {
+            return centre == s.centre and radius == s.radius;
+        }
+        /// Check for inequality
+        bool operator!=(sphere const &s) const { return not(*this == s); }
+
+        /// Apply a translation
+        sphere &operator()(translate<local_coord_type> const &t) {
+            centre = centre + centre_type{t()} * radius;
+            return *this;
+        }
+        /// Apply a transformation. Only translations and scales that are the
+        /// same along every axis can be folded into the sphere
+        sphere &operator()(std::pair<
+                           affine_matrix<local_coord_type>,
+                           affine_matrix<local_coord_type>> const &t) {
+            auto const &m = t.first;
+            auto const scale = m[0][0];
+            for (std::size_t r{}; r != 3; ++r) {
+                for (std::size_t c{}; c != 3; ++c) {
+                    if (m[r][c] != (r == c ? scale : local_coord_type{})
+                        or scale <= local_coord_type{}) {
+                        throw std::invalid_argument{
+                                "A sphere can only be translated and scaled "
+                                "by the same amount along every axis"};
+                    }
+                }
+            }
+            centre = centre + centre_type(m[0][3], m[1][3], m[2][3]) * radius;
+            radius *= scale;
+            return *this;
+        }
+
+        /// Returns a ray giving the intersection point and surface normal or
+        /// null if no intersection occurs
+        template<typename R>
+        std::optional<intersection_type> intersects(
+                R const &by,
+                typename R::local_coord_type const eps =
+                        epsilon<typename R::local_coord_type>) const {
+            using W = typename R::local_coord_type;
+            auto const &direction = cartesian_direction(by);
+            auto const &from = cartesian_from(by);
+            std::optional<W> t;
+            if constexpr (std::is_same_v<W, D>) {
+                t = first_positive_quadratic(from, direction, eps);
+            } else {
+                t = mixed_first_positive_quadratic(from, direction, eps);
+            }
+            if (t) {
+                using end_type = typename intersection_type::end_type;
+                using direction_type =
+                        typename intersection_type::direction_type;
+                auto const hit = from + direction * *t;
+                return intersection_type(
+                        end_type(hit),
+                        direction_type(
+                                direction3d<W>{hit - widen<W>(centre)}));
+            } else {
+                return {};
+            }
+        }
+
+        /// Returns true if the ray hits the sphere
+        template<typename R>
+        bool occludes(
+                R const &by,
+                typename R::local_coord_type const eps =
+                        epsilon<typename R::local_coord_type>) const {
+            using W = typename R::local_coord_type;
+            auto const &direction = cartesian_direction(by);
+            auto const &from = cartesian_from(by);
+            if constexpr (not std::is_same_v<W, D>) {
+                auto const bounded = bounded_quadratic(from, direction, eps);
+                if (bounded.certain) { return bounded.t.has_value(); }
+            }
+            auto const offset = from - widen<W>(centre);
+            W const r = radius;
+            return quadratic_has_solution(
+                    W(1), W{2} * dot(offset, direction),
+                    offset.dot() - r * r, eps);
+        }
+
+      private:
+        template<typename W>
+        static cartesian3d<W> widen(cartesian3d<D> const &c) {
+            return {W(c.x()), W(c.y()), W(c.z())};
+        }
+
+        /// Solve for the first hit at the precision of the ray
+        template<typename W>
+        std::optional<W> first_positive_quadratic(
+                cartesian3d<W> const &from,
+                direction3d<W> const &direction,
+                W const eps) const {
+            auto const offset = from - widen<W>(centre);
+            W const r = radius;
+            return first_positive_quadratic_solution(
+                    W(1), W{2} * dot(offset, direction),
+                    offset.dot() - r * r, eps);
+        }
+
+        /**
+         * Solve for the first hit in the precision of the sphere, along
+         * with bounds on the errors from narrowing the ray and rounding.
+         * The offset of the ray from the centre is out by at most `eo` in
+         * each axis, and the errors in the coefficients follow from that.
+         */
+        template<typename W>
+        bounded_quadratic_solution<D> bounded_quadratic(
+                cartesian3d<W> const &from,
+                direction3d<W> const &direction,
+                W const eps) const {
+            cartesian3d<D> const f{D(from.x()), D(from.y()), D(from.z())};
+            cartesian3d<D> const d{
+                    D(direction.x()), D(direction.y()), D(direction.z())};
+            auto const offset = f - centre;
+            auto const l1 = [](cartesian3d<D> const &v) {
+                return std::abs(v.x()) + std::abs(v.y()) + std::abs(v.z());
+            };
+            D const eo = rounding_bound<D>(2) * (l1(f) + l1(centre));
+            D const eb = D{2}
+                    * (rounding_bound<D>(4) * l1(offset) + D{2} * eo);
+            D const ec =
+                    rounding_bound<D>(4) * (offset.dot() + radius * radius)
+                    + D{2} * l1(offset) * eo + D{3} * eo * eo;
+            return first_positive_quadratic_solution(
+                    D{2} * dot(offset, d), offset.dot() - radius * radius, eb,
+                    ec, D(eps));
+        }
+
+        /// Solve in the precision of the sphere. Where that is too close to
+        /// call the ray's precision is used instead, otherwise the answer is
+        /// polished with a Newton step at the ray's precision
+        template<typename W>
+        std::optional<W> mixed_first_positive_quadratic(
+                cartesian3d<W> const &from,
+                direction3d<W> const &direction,
+                W const eps) const {
+            auto const bounded = bounded_quadratic(from, direction, eps);
+            if (not bounded.certain) {
+                return first_positive_quadratic(from, direction, eps);
+            } else if (not bounded.t) {
+                return {};
+            }
+            W t = *bounded.t;
+            W const r = radius;
+            auto const p = from - widen<W>(centre) + direction * t;
+            W const slope = W{2} * dot(p, direction);
+            if (slope != W{}) { t -= (p.dot() - r * r) / slope; }
+            return t;
+        }
+    };
+
+
+    namespace detail {
+        /// The scale of a transformation that rotates, translates and scales
+        /// by the same amount along every axis. Throws for anything else
+        template<typename D>
+        D similarity_scale(affine_matrix<D> const &m) {
+            auto const column = [&](std::size_t const c) {
+                return cartesian3d<D>{m[0][c], m[1][c], m[2][c]};
+            };
+            D const squared = column(0).dot();
+            D const tolerance = squared * std::sqrt(epsilon<D>);
+            for (std::size_t i{}; i != 3; ++i) {
+                for (std::size_t j{i}; j != 3; ++j) {
+                    D const expected = i == j ? squared : D{};
+                    if (squared <= D{}
+                        or std::abs(dot(column(i), column(j)) - expected)
+                                > tolerance) {
+                        throw std::invalid_argument{
+                                "A sphere can only be rotated, translated "
+                                "and scaled by the same amount along every "
+                                "axis"};
+                    }
+                }
+            }
+            return std::sqrt(squared);
+        }
+    }
+
+
+    /// Bake a transformation into the centre and radius of a sphere. Unlike
+    /// calling the sphere with a transformation this moves the sphere as it
+    /// is placed, in the same way as a `movable` around it does. It may
+    /// also include rotations, which leave a sphere unchanged
+    template<typename I, typename D>
+    sphere<I, D>
+            bake(sphere<I, D> const &s,
+                 std::pair<affine_matrix<D>, affine_matrix<D>> const &t) {
+        return {t.first * s.centre,
+                s.radius * detail::similarity_scale(t.first)};
+    }
+    template<typename I, typename D>
+    sphere<I, D>
+            bake(unit_sphere_at_origin<I, D> const &,
+                 std::pair<affine_matrix<D>, affine_matrix<D>> const &t) {
+        return bake(sphere<I, D>{}, t);
+    }
+
+
+}
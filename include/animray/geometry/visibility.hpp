@@ -0,0 +1,296 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/epsilon.hpp>
+#include <animray/point3d.hpp>
+#include <animray/ray.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+
+namespace animray {
+
+
+    /**
+     * ## Shadow map
+     *
+     * The distance to the first surface seen from a point light in every
+     * direction, stored as a cube map. Each face is a grid of
+     * `resolution` by `resolution` texels, and the distance is traced at
+     * the corners of every texel.
+     *
+     * The distance to the first surface in a point's direction is
+     * interpolated from the corners of its texel. A point no further from
+     * the light than that, give or take the `bias` (as a fraction of the
+     * width of a texel at the point's distance), is lit and one further
+     * away is in shadow. Where the distances around the texel don't lie
+     * on a smooth surface, at the edge of a shadow for example, the caller
+     * has to trace the ray. Anything closer to the point than the bias,
+     * and things smaller than a texel, can still be missed, so the
+     * resolution needs to suit the scene.
+     *
+     * Like `occludes`, anything on the far side of the light along the
+     * ray also blocks it.
+     */
+    template<typename W>
+    class shadow_map {
+        point3d<W> m_light;
+        std::size_t m_resolution;
+        W m_bias;
+        /// The distances for each face. Infinite where nothing is struck
+        std::vector<W> m_depth;
+
+        static constexpr W nothing = std::numeric_limits<W>::infinity();
+
+        /// The face and position on it for a direction
+        struct texel {
+            std::size_t face;
+            W u, v;
+        };
+        static texel project(point3d<W> const &d) {
+            W const ax = std::abs(d.x()), ay = std::abs(d.y()),
+                    az = std::abs(d.z());
+            if (ax >= ay and ax >= az) {
+                return {d.x() < 0 ? 1u : 0u, d.y() / ax, d.z() / ax};
+            } else if (ay >= az) {
+                return {d.y() < 0 ? 3u : 2u, d.x() / ay, d.z() / ay};
+            } else {
+                return {d.z() < 0 ? 5u : 4u, d.x() / az, d.y() / az};
+            }
+        }
+        static point3d<W> unproject(std::size_t const face, W u, W v) {
+            W const sign = face % 2 ? W{-1} : W{1};
+            switch (face / 2) {
+            case 0: return {sign, u, v};
+            case 1: return {u, sign, v};
+            default: return {u, v, sign};
+            }
+        }
+
+        W &depth(
+                std::size_t const face, std::size_t const i, std::size_t j) {
+            return m_depth[(face * (m_resolution + 1) + j) * (m_resolution + 1)
+                           + i];
+        }
+        W depth(std::size_t const face, std::size_t const i, std::size_t j)
+                const {
+            return m_depth[(face * (m_resolution + 1) + j) * (m_resolution + 1)
+                           + i];
+        }
+
+        /// The nearest and furthest corner around the texel in direction
+        /// `d`. The texels next to it are included so that small things
+        /// that fall between the corners of one texel are still seen
+        std::pair<W, W> range(point3d<W> const &d) const {
+            auto const t = project(d);
+            auto const cell = [this](W const c) {
+                return std::min(
+                        std::size_t((c + W{1}) / W{2} * m_resolution),
+                        m_resolution - 1);
+            };
+            std::size_t const i = cell(t.u), j = cell(t.v);
+            W lo = nothing, hi = W{};
+            for (std::size_t y = j ? j - 1 : j;
+                 y <= std::min(j + 2, m_resolution); ++y) {
+                for (std::size_t x = i ? i - 1 : i;
+                     x <= std::min(i + 2, m_resolution); ++x) {
+                    lo = std::min(lo, depth(t.face, x, y));
+                    hi = std::max(hi, depth(t.face, x, y));
+                }
+            }
+            return {lo, hi};
+        }
+
+        /// The distance to the first surface in direction `d`, or nothing
+        /// if the corners around its texel bend by more than `tolerance`
+        std::optional<W> surface(point3d<W> const &d, W const tolerance) const {
+            auto const t = project(d);
+            W const fu = (t.u + W{1}) / W{2} * m_resolution,
+                    fv = (t.v + W{1}) / W{2} * m_resolution;
+            std::size_t const i = std::min(std::size_t(fu), m_resolution - 1),
+                              j = std::min(std::size_t(fv), m_resolution - 1);
+            if (i == 0 or j == 0 or i + 2 > m_resolution
+                or j + 2 > m_resolution) {
+                return {};
+            }
+            /// The comparison is this way around so that corners where
+            /// nothing is struck count as bending
+            auto const bend = [tolerance](W const a, W const b, W const c) {
+                return not(std::abs(a - W{2} * b + c) <= tolerance);
+            };
+            for (std::size_t n{}; n != 4; ++n) {
+                for (std::size_t m{}; m != 2; ++m) {
+                    std::size_t const x = i - 1 + n, y = j - 1 + n;
+                    if (bend(depth(t.face, x, j + m - 1),
+                             depth(t.face, x, j + m),
+                             depth(t.face, x, j + m + 1))
+                        or bend(depth(t.face, i + m - 1, y),
+                                depth(t.face, i + m, y),
+                                depth(t.face, i + m + 1, y))) {
+                        return {};
+                    }
+                }
+            }
+            W const a = fu - i, b = fv - j;
+            return (depth(t.face, i, j) * (W{1} - a)
+                    + depth(t.face, i + 1, j) * a)
+                    * (W{1} - b)
+                    + (depth(t.face, i, j + 1) * (W{1} - a)
+                       + depth(t.face, i + 1, j + 1) * a)
+                    * b;
+        }
+
+      public:
+        /// Trace the map for a light at `light` in the `geometry`
+        template<typename G>
+        shadow_map(
+                G const &geometry,
+                point3d<W> light,
+                std::size_t const resolution = 512,
+                W const bias = W{0.25})
+        : m_light{std::move(light)},
+          m_resolution{resolution},
+          m_bias{bias},
+          m_depth(6 * (resolution + 1) * (resolution + 1)) {
+            if (resolution == 0) {
+                throw std::invalid_argument{
+                        "A shadow map needs at least one texel"};
+            }
+            for (std::size_t face{}; face != 6; ++face) {
+                for (std::size_t j{}; j <= m_resolution; ++j) {
+                    for (std::size_t i{}; i <= m_resolution; ++i) {
+                        W const u = W{2} * i / m_resolution - W{1},
+                                v = W{2} * j / m_resolution - W{1};
+                        ray<W> const from_light{
+                                m_light, m_light + unproject(face, u, v)};
+                        auto const hit =
+                                geometry.intersects(from_light, epsilon<W>);
+                        depth(face, i, j) = hit
+                                ? std::sqrt((hit->from - m_light).dot())
+                                : nothing;
+                    }
+                }
+            }
+        }
+
+        /// The position of the light
+        point3d<W> const &light() const { return m_light; }
+
+        /// Whether the ray from `point` to the light is blocked, or nothing
+        /// if the map can't tell
+        std::optional<bool> occluded(point3d<W> const &point) const {
+            point3d<W> const d = point - m_light;
+            W const distance = std::sqrt(d.dot());
+            auto const [behind_lo, behind_hi] = range(-d);
+            if (behind_hi < nothing) {
+                return true;
+            } else if (behind_lo < nothing) {
+                return {};
+            }
+            W const band = m_bias * W{2} * distance / m_resolution;
+            if (auto const first = surface(d, band); first) {
+                return distance > *first + band;
+            } else {
+                return {};
+            }
+        }
+    };
+
+
+    /**
+     * ## Visibility cache
+     *
+     * Wraps the geometry of a scene whose point lights and geometry don't
+     * move, so that shadow rays towards those lights are answered from a
+     * `shadow_map` built once up front. Rays the maps can't answer, and
+     * all other rays, go to the geometry as normal. This suits animations
+     * where only the camera moves.
+     */
+    template<typename G>
+    class visibility_cache {
+      public:
+        /// The wrapped geometry
+        using geometry_type = G;
+        /// The type of the local coordinates used
+        using local_coord_type = typename G::local_coord_type;
+        /// Type of intersection to be returned
+        using intersection_type = typename G::intersection_type;
+
+        /// The geometry itself
+        geometry_type geometry;
+
+        /// Build the shadow maps for the lights at `lights`
+        visibility_cache(
+                G g,
+                std::span<point3d<local_coord_type> const> const lights,
+                std::size_t const resolution = 512,
+                local_coord_type const bias = local_coord_type{0.25})
+        : geometry{std::move(g)} {
+            for (auto const &light : lights) {
+                maps.emplace_back(geometry, light, resolution, bias);
+            }
+        }
+
+        /// Forwarded to the geometry
+        template<typename R, typename E>
+        std::optional<intersection_type>
+                intersects(R const &by, E const epsilon) const {
+            return geometry.intersects(by, epsilon);
+        }
+
+        /// Answered from a shadow map when the ray heads straight for one
+        /// of the lights
+        template<typename R, typename E>
+        bool occludes(R const &by, E const epsilon) const {
+            for (auto const &map : maps) {
+                if (aims_at(by, map.light())) {
+                    if (auto const o = map.occluded(by.from)) { return *o; }
+                    break;
+                }
+            }
+            return geometry.occludes(by, epsilon);
+        }
+
+      private:
+        std::vector<shadow_map<local_coord_type>> maps;
+
+        template<typename R>
+        static bool aims_at(R const &by, point3d<local_coord_type> const &l) {
+            auto const d = l - by.from;
+            auto const length2 = d.dot();
+            auto const off = d - by.direction * std::sqrt(length2);
+            /// Allow for the rounding in normalising the direction
+            auto constexpr slack = 64
+                    * std::numeric_limits<local_coord_type>::epsilon();
+            return off.dot() <= length2 * slack * slack;
+        }
+    };
+
+
+}
@@ -48,6 +48,10 @@ namespace animray {
         explicit constexpr light(std::array<L, N> l) noexcept
         : lights{std::move(l)} {}
 
+        /// Iterate over the lights
+        auto begin() const { return lights.begin(); }
+        auto end() const { return lights.end(); }
+
         /// Calculate the illumination given by this light
         template<typename O, typename R, typename G>
         color_type operator()(
@@ -83,6 +87,10 @@ namespace animray {
             return *this;
         }
 
+        /// Iterate over the lights
+        auto begin() const { return lights.begin(); }
+        auto end() const { return lights.end(); }
+
         /// Calculate the illumination given by this light
         template<typename O, typename R, typename G>
         color_type operator()(
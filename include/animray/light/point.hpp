@@ -24,6 +24,7 @@
 
 
 #include <animray/light/light.hpp>
+#include <animray/occluder.hpp>
 #include <animray/shader.hpp>
 #include <animray/ray.hpp>
 #include <animray/epsilon.hpp>
@@ -45,6 +46,10 @@ namespace animray {
 
         /// The geometry of the light
         geometry_type geometry;
+        /// Whether each thread remembers what last blocked this light and
+        /// checks that first. Neighbouring points are often in the shadow
+        /// of the same thing
+        bool remember_occluder = true;
 
         /// Construct from a position and color
         constexpr light(geometry_type p, typename superclass::color_type c)
@@ -54,11 +59,13 @@ namespace animray {
         template<typename O, typename I, typename G>
         typename superclass::color_type operator()(
                 const O &observer, const I &intersection, const G &scene) const {
+            if (not is_lit(intersection)) {
+                return typename superclass::color_type();
+            }
             O illumination(observer);
             illumination.from = intersection.from;
             illumination.to(geometry);
-            if (not scene.geometry.occludes(
-                        illumination, epsilon<local_coord_type>)) {
+            if (not occluded(illumination, scene.geometry)) {
                 return shader(
                         observer, illumination, intersection, superclass::color,
                         scene);
@@ -66,6 +73,23 @@ namespace animray {
                 return typename superclass::color_type();
             }
         }
+
+      private:
+        template<typename R, typename G>
+        bool occluded(R const &illumination, G const &geometry) const {
+            auto const eps = epsilon<local_coord_type>;
+            if constexpr (IndexedOcclusion<G, R, local_coord_type>) {
+                if (remember_occluder) {
+                    auto &last = last_occluder(this);
+                    if (last and geometry.occludes(illumination, eps, *last)) {
+                        return true;
+                    }
+                    last = geometry.occluder(illumination, eps);
+                    return last.has_value();
+                }
+            }
+            return geometry.occludes(illumination, eps);
+        }
     };
 
 
@@ -0,0 +1,75 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/light/ambient.hpp>
+#include <animray/light/collection.hpp>
+#include <animray/light/point.hpp>
+
+#include <vector>
+
+
+namespace animray {
+
+
+    /// Ambient lights have no position
+    template<typename W, typename C>
+    void light_positions(light<void, C> const &, std::vector<point3d<W>> &) {}
+
+    /// The position of a point light
+    template<typename W, typename C>
+    void light_positions(
+            light<point3d<W>, C> const &l, std::vector<point3d<W>> &into) {
+        into.push_back(l.geometry);
+    }
+
+    /// The positions of the point lights in a collection
+    template<typename W, typename C, typename L, std::size_t N>
+    void light_positions(
+            light<std::array<L, N>, C> const &l,
+            std::vector<point3d<W>> &into) {
+        for (auto const &i : l) { light_positions(i, into); }
+    }
+    template<typename W, typename C, typename L>
+    void light_positions(
+            light<std::vector<L>, C> const &l, std::vector<point3d<W>> &into) {
+        for (auto const &i : l) { light_positions(i, into); }
+    }
+    template<typename W, typename C, typename... Ls>
+    void light_positions(
+            light<std::tuple<Ls...>, C> const &l,
+            std::vector<point3d<W>> &into) {
+        std::apply(
+                [&](auto const &...i) { (light_positions(i, into), ...); },
+                static_cast<std::tuple<Ls...> const &>(l));
+    }
+
+    /// The positions of all of the point lights in `l`
+    template<typename W, typename L>
+    std::vector<point3d<W>> light_positions(L const &l) {
+        std::vector<point3d<W>> into;
+        light_positions(l, into);
+        return into;
+    }
+
+
+}
@@ -0,0 +1,117 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/color/brightness.hpp>
+#include <animray/light/light.hpp>
+#include <animray/maths/alias-table.hpp>
+#include <animray/threading/random-generator.hpp>
+
+#include <vector>
+
+
+namespace animray {
+
+
+    /// Used as the light geometry for a collection of lights of a single
+    /// type where only `K` of them are used for each sample
+    template<Light L, std::size_t K = 1>
+    struct sampled {};
+
+
+    namespace detail {
+        /// How bright a light is, used to decide how often it is sampled
+        template<typename L>
+        double light_power(L const &l) {
+            if constexpr (requires { l.color; }) {
+                return brightness(l.color);
+            } else {
+                return 1;
+            }
+        }
+    }
+
+
+    /**
+     * ## Sampled light collection
+     *
+     * Rather than adding up every light for every shading point, `K`
+     * lights are picked at random, each with a probability proportional to
+     * its power, and their light is divided by how likely they were to be
+     * picked. On average this gives the same light as the whole
+     * collection, but the cost doesn't grow with the number of lights.
+     * The random numbers are drawn from the counter based engine.
+     */
+    template<typename C, Light L, std::size_t K>
+    class light<sampled<L, K>, C> {
+      public:
+        /// The container type
+        using container_type = std::vector<L>;
+        /// The type of the light
+        using light_type = L;
+        /// The colour model
+        using color_type = C;
+
+        /// An empty collection
+        light() = default;
+        /// Place the lights
+        explicit light(container_type l) : lights{std::move(l)} { index(); }
+
+        /// Add a light to this collection
+        auto &push_back(const light_type &light) {
+            lights.push_back(light);
+            index();
+            return *this;
+        }
+
+        /// Calculate the illumination given by this light
+        template<typename O, typename R, typename G>
+        color_type operator()(
+                const O &observer, const R &intersection, const G &scene) const {
+            color_type c{};
+            if (lights.empty()) { return c; }
+            for (std::size_t k{}; k != K; ++k) {
+                auto const [i, p] = table.sample(
+                        unit_interval<double>(random::counter::e()));
+                c += color_type(
+                        lights[i](observer, intersection, scene)
+                        * (1 / (K * p)));
+            }
+            return c;
+        }
+
+      private:
+        container_type lights;
+        alias_table table;
+
+        void index() {
+            std::vector<double> power;
+            power.reserve(lights.size());
+            for (auto const &l : lights) {
+                power.push_back(detail::light_power(l));
+            }
+            table = alias_table{power};
+        }
+    };
+
+
+}
@@ -0,0 +1,110 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace animray {
+
+
+    /**
+     * ## Alias table
+     *
+     * Picks an index with a probability proportional to its weight in
+     * constant time, however many weights there are (Vose, "A linear
+     * algorithm for generating random numbers with a given distribution").
+     * Each slot holds the chance of keeping its own index and the index
+     * to use instead.
+     */
+    class alias_table {
+        struct slot {
+            double keep = 1;
+            std::size_t alias = {};
+            double probability = {};
+        };
+        std::vector<slot> slots;
+
+      public:
+        alias_table() = default;
+        /// Build the table from the weights. If they are all zero every
+        /// index is equally likely
+        explicit alias_table(std::span<double const> const weights)
+        : slots(weights.size()) {
+            double total{};
+            for (auto const w : weights) {
+                if (w < 0) {
+                    throw std::invalid_argument{
+                            "Alias table weights must not be negative"};
+                }
+                total += w;
+            }
+            std::size_t const n = weights.size();
+            std::vector<std::size_t> small, large;
+            std::vector<double> scaled(n);
+            for (std::size_t i{}; i != n; ++i) {
+                slots[i].probability =
+                        total > 0 ? weights[i] / total : 1.0 / n;
+                scaled[i] = slots[i].probability * n;
+                (scaled[i] < 1 ? small : large).push_back(i);
+            }
+            while (not small.empty() and not large.empty()) {
+                std::size_t const s = small.back(), l = large.back();
+                small.pop_back();
+                slots[s].keep = scaled[s];
+                slots[s].alias = l;
+                scaled[l] -= 1 - scaled[s];
+                if (scaled[l] < 1) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            // Whatever is left over is only off by rounding
+            for (auto const i : large) { slots[i].keep = 1; }
+            for (auto const i : small) { slots[i].keep = 1; }
+        }
+
+        /// The number of indexes the table chooses between
+        std::size_t size() const { return slots.size(); }
+
+        /// The probability that `index` is picked
+        double probability(std::size_t const index) const {
+            return slots[index].probability;
+        }
+
+        /// Pick an index using `u` from `[0, 1)`. Returns the index and the
+        /// probability that it is picked
+        std::pair<std::size_t, double> sample(double const u) const {
+            double const scaled = u * slots.size();
+            std::size_t i = std::min(std::size_t(scaled), slots.size() - 1);
+            if (scaled - i >= slots[i].keep) { i = slots[i].alias; }
+            return {i, slots[i].probability};
+        }
+    };
+
+
+}
@@ -24,7 +24,7 @@
 #pragma once
 
 
-#include <animray/unit-vector.hpp>
+#include <animray/cartesian3d.hpp>
 
 
 namespace animray {
@@ -45,6 +45,20 @@ namespace animray {
                 b.x() * c.y() - b.y() * c.x());
     }
 
+    /// Cross products for Cartesian vectors and directions
+    template<typename D>
+    constexpr cartesian3d<D>
+            cross(cartesian3d<D> const &b, cartesian3d<D> const &c) {
+        return {b.y() * c.z() - b.z() * c.y(), b.z() * c.x() - b.x() * c.z(),
+                b.x() * c.y() - b.y() * c.x()};
+    }
+    template<typename D>
+    constexpr cartesian3d<D>
+            cross(direction3d<D> const &b, cartesian3d<D> const &c) {
+        return {b.y() * c.z() - b.z() * c.y(), b.z() * c.x() - b.x() * c.z(),
+                b.x() * c.y() - b.y() * c.x()};
+    }
+
 
 }
 
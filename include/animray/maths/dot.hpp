@@ -24,7 +24,7 @@
 #pragma once
 
 
-#include <animray/unit-vector.hpp>
+#include <animray/cartesian3d.hpp>
 
 
 namespace animray {
@@ -51,6 +51,24 @@ namespace animray {
         return d1.x() * d2.x() + d1.y() * d2.y() + d1.z() * d2.z();
     }
 
+    /// Dot products for Cartesian vectors and directions
+    template<typename D>
+    constexpr D dot(cartesian3d<D> const &d1, cartesian3d<D> const &d2) {
+        return d1.x() * d2.x() + d1.y() * d2.y() + d1.z() * d2.z();
+    }
+    template<typename D>
+    constexpr D dot(cartesian3d<D> const &d1, direction3d<D> const &d2) {
+        return d1.x() * d2.x() + d1.y() * d2.y() + d1.z() * d2.z();
+    }
+    template<typename D>
+    constexpr D dot(direction3d<D> const &d1, cartesian3d<D> const &d2) {
+        return d1.x() * d2.x() + d1.y() * d2.y() + d1.z() * d2.z();
+    }
+    template<typename D>
+    constexpr D dot(direction3d<D> const &d1, direction3d<D> const &d2) {
+        return d1.x() * d2.x() + d1.y() * d2.y() + d1.z() * d2.z();
+    }
+
 
 }
 
@@ -0,0 +1,74 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <array>
+#include <cstdint>
+
+
+namespace animray {
+
+
+    /**
+     * ## Philox 4x32-10
+     *
+     * A counter based random number generator (Salmon et al., "Parallel
+     * random numbers: as easy as 1, 2, 3"). Each distinct counter gives
+     * four unrelated 32 bit values for the key. There is no state, so the
+     * values depend only on what is being sampled and never on the order
+     * in which things are worked out.
+     */
+    constexpr std::array<std::uint32_t, 4> philox(
+            std::array<std::uint32_t, 4> counter,
+            std::array<std::uint32_t, 2> key) {
+        constexpr std::uint64_t m0 = 0xd2511f53, m1 = 0xcd9e8d57;
+        constexpr std::uint32_t w0 = 0x9e3779b9, w1 = 0xbb67ae85;
+        for (std::size_t round{}; round != 10; ++round) {
+            if (round) {
+                key[0] += w0;
+                key[1] += w1;
+            }
+            std::uint64_t const p0 = m0 * counter[0];
+            std::uint64_t const p1 = m1 * counter[2];
+            counter = {
+                    std::uint32_t(p1 >> 32) ^ counter[1] ^ key[0],
+                    std::uint32_t(p1),
+                    std::uint32_t(p0 >> 32) ^ counter[3] ^ key[1],
+                    std::uint32_t(p0)};
+        }
+        return counter;
+    }
+
+
+    /// Turn 32 random bits into a value in `[0, 1)`. A `float` only uses
+    /// the top 24 bits so that the result can't round up to one
+    template<typename T>
+    constexpr T unit_interval(std::uint32_t const bits) {
+        if constexpr (sizeof(T) <= sizeof(float)) {
+            return T(bits >> 8) * T(1.0 / (1 << 24));
+        } else {
+            return T(bits) * T(1.0 / 4294967296.0);
+        }
+    }
+
+
+}
@@ -0,0 +1,65 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// Squaring anything closer to zero than this gives a number below
+        /// the normal range, which is slow to work with
+        template<std::floating_point T>
+        constexpr T square_floor() {
+            T t{1};
+            for (int i{}; i < (1 - std::numeric_limits<T>::min_exponent) / 2;
+                 ++i) {
+                t /= 2;
+            }
+            return t;
+        }
+    }
+
+
+    /// `x` to the power of the whole number `n` by repeated squaring.
+    /// Floating point results that would be below the normal range are
+    /// zero
+    template<typename T>
+    constexpr T whole_pow(T x, std::uint64_t n) {
+        T r{1};
+        while (true) {
+            if (n & 1) { r *= x; }
+            n >>= 1;
+            if (not n) { return r; }
+            if constexpr (std::floating_point<T>) {
+                constexpr T floor = detail::square_floor<T>();
+                if (-floor < x and x < floor) { return T{}; }
+            }
+            x *= x;
+        }
+    }
+
+}
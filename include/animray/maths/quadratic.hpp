@@ -23,6 +23,8 @@
 #pragma once
 
 
+#include <animray/epsilon.hpp>
+
 #include <cmath>
 #include <optional>
 
@@ -66,6 +68,68 @@ namespace animray {
     }
 
 
+
+    /// The result of solving a quadratic whose coefficients are only known
+    /// to within an error bound
+    template<typename D>
+    struct bounded_quadratic_solution {
+        /// False when the errors are large enough that the solution found
+        /// might not be the right one
+        bool certain = true;
+        /// The smallest solution inside the range, if there is one
+        std::optional<D> t = {};
+    };
+
+
+    /**
+     * Returns the smallest real solution inside the range to the quadratic
+     * `t² + bt + c`, where `b` and `c` may be wrong by up to `eb` and `ec`.
+     * The rounding in the calculation is also accounted for. When the
+     * errors could change whether there is a solution, or which one is the
+     * first in the range, the result is marked as uncertain and the caller
+     * should work it out again at a higher precision.
+     */
+    template<typename D>
+    inline bounded_quadratic_solution<D> first_positive_quadratic_solution(
+            D const b, D const c, D const eb, D const ec, D const range) {
+        D const discriminant = b * b - D{4} * c;
+        D const discriminant_error =
+                rounding_bound<D>(2) * (b * b + D{4} * std::abs(c))
+                + D{2} * std::abs(b) * eb + eb * eb + D{4} * ec;
+        if (discriminant + discriminant_error < D{}) {
+            return {};
+        } else if (discriminant - discriminant_error <= D{}) {
+            return {false};
+        }
+        D const root_discrim = std::sqrt(discriminant);
+        D const root_error = discriminant_error / root_discrim
+                + rounding_bound<D>(1) * root_discrim;
+        D const q = -(D{1} / D{2})
+                * (b + (b < D{} ? -root_discrim : root_discrim));
+        D const q_error = (eb + root_error) / D{2}
+                + rounding_bound<D>(2) * std::abs(q);
+        D t0 = q, t1 = c / q;
+        D e0 = q_error,
+          e1 = (ec + std::abs(t1) * q_error) / std::abs(q)
+                + rounding_bound<D>(1) * std::abs(t1);
+        if (t1 < t0) {
+            std::swap(t0, t1);
+            std::swap(e0, e1);
+        }
+        if (t0 - e0 >= range) {
+            return {true, t0};
+        } else if (t0 + e0 >= range) {
+            return {false};
+        } else if (t1 - e1 >= range) {
+            return {true, t1};
+        } else if (t1 + e1 >= range) {
+            return {false};
+        } else {
+            return {};
+        }
+    }
+
+
 }
 
 
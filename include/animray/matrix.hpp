@@ -106,24 +106,29 @@ namespace animray {
         /// Multiply two matrixes
         matrix operator*(const matrix &r) const {
             matrix result;
-            const point3d<value_type> cols[4] = {
-                    r.column(0), r.column(1), r.column(2), r.column(3)};
-            for (std::size_t row(0); row < 4; ++row) {
-                const_row_proxy my_row((*this)[row]);
-                row_proxy res_row(result[row]);
+            auto const &a = superclass::array;
+            auto const &b = r.superclass::array;
+            auto &c = result.superclass::array;
+            for (std::size_t row(0); row < 16; row += 4) {
                 for (std::size_t col(0); col < 4; ++col) {
-                    res_row[col] = sum((my_row * cols[col]).array());
+                    c[row + col] = a[row] * b[col] + a[row + 1] * b[col + 4]
+                            + a[row + 2] * b[col + 8]
+                            + a[row + 3] * b[col + 12];
                 }
             }
             return result;
         }
         /// Multiply by a vector
         point3d<value_type> operator*(const point3d<value_type> v) const {
-            return point3d<value_type>(
-                    sum(((*this)[0] * v).array()),
-                    sum(((*this)[1] * v).array()),
-                    sum(((*this)[2] * v).array()),
-                    sum(((*this)[3] * v).array()));
+            auto const &m = superclass::array;
+            auto const &h = v.array();
+            std::array<value_type, 4> p;
+            for (std::size_t row(0); row < 4; ++row) {
+                p[row] = sum(std::array<value_type, 4>{
+                        m[row * 4] * h[0], m[row * 4 + 1] * h[1],
+                        m[row * 4 + 2] * h[2], m[row * 4 + 3] * h[3]});
+            }
+            return point3d<value_type>(p[0], p[1], p[2], p[3]);
         }
 
         /// Multiply by another matrix
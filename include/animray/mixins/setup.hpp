@@ -0,0 +1,147 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/maths/dot.hpp>
+#include <animray/ray.hpp>
+
+#include <type_traits>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// Non-templated base class used for matching
+        struct ray_setup_base_class {};
+
+        /// The values the intersection kernels derive from a ray
+        template<typename D>
+        struct ray_setup : ray_setup_base_class {
+            ray_setup() {}
+            template<typename R>
+            explicit ray_setup(R const &by)
+            : cartesian_from{cartesian(by.from)},
+              cartesian_direction{cartesian(by.direction)},
+              from_dot_direction{dot(cartesian_from, cartesian_direction)},
+              from_dot_from{cartesian_from.dot()} {
+                for (std::size_t a{}; a != 3; ++a) {
+                    inverse[a] = D(1) / cartesian_direction.array()[a];
+                }
+            }
+
+            /// The start and direction of the ray in Cartesian form
+            cartesian3d<D> cartesian_from;
+            direction3d<D> cartesian_direction;
+            /// The reciprocal of the direction, used for slab tests
+            std::array<D, 3> inverse = {};
+            /// Dot products of the start with the direction and itself
+            D from_dot_direction{}, from_dot_from{};
+        };
+
+        /// A ray together with its set up values
+        template<typename R>
+        class set_up_ray :
+        public R,
+        public ray_setup<typename R::local_coord_type> {
+            using setup_type = ray_setup<typename R::local_coord_type>;
+
+          public:
+            explicit set_up_ray(R const &r) : R{r}, setup_type{r} {}
+
+            /// Transforming the ray means the values have to be worked out
+            /// again
+            template<typename B>
+            set_up_ray &operator*=(B const &by) {
+                R::operator*=(by);
+                static_cast<setup_type &>(*this) = setup_type{*this};
+                return *this;
+            }
+            /// A transformed copy is only used in the new co-ordinate
+            /// system, so it is returned as a plain ray. Whatever is
+            /// struck there can work out only the values it needs
+            template<typename B>
+            R operator*(B const &by) const {
+                return static_cast<R const &>(*this) * by;
+            }
+        };
+    }
+
+
+    /// True if the ray carries its set up values
+    template<typename R>
+    constexpr bool is_set_up =
+            std::is_base_of_v<detail::ray_setup_base_class, R>;
+
+
+    /**
+     * ## Ray set up
+     *
+     * Adds the values that the intersection kernels work out from a ray:
+     * the start and direction in Cartesian form, the reciprocal of the
+     * direction and the dot products of the start. Geometry that tests
+     * the same ray against many objects, like `collection`, sets the ray
+     * up once so that each object only has to read them.
+     *
+     * The values are only correct for the `from` and `direction` they were
+     * worked out from, so a set up ray is for passing down into geometry
+     * and must not be changed in place.
+     */
+    template<typename T>
+    struct with_setup {
+        using type = std::conditional_t<
+                is_set_up<T>, T, detail::set_up_ray<T>>;
+    };
+
+
+    /// Set up a ray, unless it has been already
+    template<typename R>
+    decltype(auto) set_up(R const &by) {
+        if constexpr (is_set_up<R>) {
+            return (by);
+        } else {
+            return typename with_setup<R>::type{by};
+        }
+    }
+
+
+    /// The start of the ray in Cartesian form
+    template<typename R>
+    decltype(auto) cartesian_from(R const &by) {
+        if constexpr (is_set_up<R>) {
+            return (by.cartesian_from);
+        } else {
+            return cartesian(by.from);
+        }
+    }
+    /// The direction of the ray in Cartesian form
+    template<typename R>
+    decltype(auto) cartesian_direction(R const &by) {
+        if constexpr (is_set_up<R>) {
+            return (by.cartesian_direction);
+        } else {
+            return cartesian(by.direction);
+        }
+    }
+
+
+}
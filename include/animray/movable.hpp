@@ -25,13 +25,19 @@
 
 #include <animray/affine.hpp>
 #include <animray/ray.hpp>
-#include <animray/matrix.hpp>
 #include <optional>
+#include <tuple>
+#include <type_traits>
 
 
 namespace animray {
 
 
+    /// Forward declaration of the surface
+    template<typename O, typename... S>
+    struct surface;
+
+
     /// Handles forward and backward transformation between 3D co-ordinate systems
     template<typename M>
     class transformable {
@@ -58,6 +64,10 @@ namespace animray {
             backward *= t.forward();
             return *this;
         }
+
+        /// The transformation built up so far, in the same form as the
+        /// transformations that are applied
+        transform_type transformation() const { return {backward, forward}; }
     };
 
 
@@ -65,7 +75,8 @@ namespace animray {
     template<
             typename O,
             typename I = typename O::intersection_type,
-            typename T = transformable<matrix<typename O::local_coord_type>>>
+            typename T =
+                    transformable<affine_matrix<typename O::local_coord_type>>>
     class movable : private T {
         using superclass = T;
 
@@ -98,6 +109,8 @@ namespace animray {
             return *this;
         }
 
+        using superclass::transformation;
+
         /// Ray intersection
         template<typename R, typename E>
         std::optional<intersection_type>
@@ -105,7 +118,10 @@ namespace animray {
             const auto hit{
                     instance.intersects(by * superclass::forward, epsilon)};
             if (hit) {
-                return hit.value() * superclass::backward;
+                auto world{hit.value()};
+                world.transform_normal(
+                        superclass::backward, superclass::forward);
+                return world;
             } else {
                 return {};
             }
@@ -122,9 +138,104 @@ namespace animray {
         intersection_type operator()(F x, F y) const {
             return instance(x, y) * superclass::backward;
         }
+
+        /// Fill a batch with the rays for a tile of a camera. The
+        /// transformation is passed down so the camera can apply it to its
+        /// axes instead of to each ray
+        template<typename B>
+        void
+                fill(B &batch,
+                     std::size_t const x,
+                     std::size_t const y,
+                     std::size_t const columns,
+                     std::size_t const rows,
+                     typename transform_type::first_type const &to_world =
+                             {}) const {
+            instance.fill(
+                    batch, x, y, columns, rows,
+                    to_world * superclass::backward);
+        }
     };
 
 
+    /// Combine two transformations. `inner` is applied to the local
+    /// co-ordinates first, in the same way as calling a `movable` with
+    /// `outer` and then with `inner`
+    template<typename M>
+    std::pair<M, M> compose(
+            std::pair<M, M> const &outer, std::pair<M, M> const &inner) {
+        return {outer.first * inner.first, inner.second * outer.second};
+    }
+
+
+    /**
+     * ## Flattening
+     *
+     * A `movable` nested inside another `movable`, either directly or as
+     * the geometry of a `surface`, transforms every ray twice. `flatten`
+     * returns a single `movable` around the innermost instance that holds
+     * the combined transformation. It is done when the scene is built, and
+     * changes the type, so the result needs to be stored as a new object.
+     */
+    template<typename O, typename I, typename T>
+    movable<O, I, T> const &flatten(movable<O, I, T> const &m) {
+        return m;
+    }
+    template<typename O, typename I2, typename T2, typename I, typename T>
+    auto flatten(movable<movable<O, I2, T2>, I, T> const &m) {
+        movable<O, I, T> flat{m.instance.instance};
+        flat(compose(m.transformation(), m.instance.transformation()));
+        return flatten(flat);
+    }
+    template<
+            typename O,
+            typename I2,
+            typename T2,
+            typename... S,
+            typename I,
+            typename T>
+    auto flatten(movable<surface<movable<O, I2, T2>, S...>, I, T> const &m) {
+        /// The default intersection type names the nested `movable`, so
+        /// only an intersection type that was chosen is kept
+        using flat_intersection = std::conditional_t<
+                std::is_same_v<
+                        I,
+                        typename surface<
+                                movable<O, I2, T2>, S...>::intersection_type>,
+                typename surface<O, S...>::intersection_type, I>;
+        using flat_type = movable<surface<O, S...>, flat_intersection, T>;
+        flat_type flat{std::apply(
+                [&](auto const &...s) {
+                    return surface<O, S...>{m.instance.geometry.instance, s...};
+                },
+                m.instance.surfaces)};
+        flat(compose(m.transformation(), m.instance.geometry.transformation()));
+        return flatten(flat);
+    }
+
+
+    /**
+     * ## Baking
+     *
+     * Static geometry can have the transformation of the `movable` around
+     * it applied to its own data, so that rays reach it without being
+     * transformed at all. `bake` does this for any instance that has a
+     * `bake(instance, transformation)` overload, which is found through
+     * argument dependent lookup. Nested `movable` instances are combined
+     * on the way down.
+     */
+    template<typename O, typename I, typename T>
+    auto bake(movable<O, I, T> const &m) {
+        return bake(m.instance, m.transformation());
+    }
+    template<typename O, typename I, typename T>
+    auto bake(
+            movable<O, I, T> const &m,
+            typename T::transform_type const &outer) {
+        return bake(m.instance, compose(outer, m.transformation()));
+    }
+
+
 }
 
 
@@ -0,0 +1,105 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+
+namespace animray {
+
+
+    /**
+     * ## Finding the occluder
+     *
+     * Geometry made up of other geometry can say which part of it blocks
+     * a ray, as a number from `occluder`, and can then check just that
+     * part with `occludes(by, epsilon, occluder)`. The number is only
+     * good for the geometry that gave it out, and a number that is out of
+     * date only makes the check slower.
+     *
+     * Containers number their parts from zero and fold in the number
+     * from the part itself, if it has one. So for `n` parts, part `i`
+     * whose own number is `j` has the number `i + n * j`.
+     */
+    template<typename G, typename R, typename E>
+    concept IndexedOcclusion = requires(
+            G const &g, R const &by, E const epsilon, std::size_t const at) {
+        {
+            g.occluder(by, epsilon)
+            } -> std::same_as<std::optional<std::size_t>>;
+        { g.occludes(by, epsilon, at) } -> std::same_as<bool>;
+    };
+
+
+    /// The number for the part of the geometry that occludes the ray, if
+    /// any. Geometry that can't say which part gets zero
+    template<typename G, typename R, typename E>
+    std::optional<std::size_t>
+            occluder_of(G const &geometry, R const &by, E const epsilon) {
+        if constexpr (IndexedOcclusion<G, R, E>) {
+            return geometry.occluder(by, epsilon);
+        } else if (geometry.occludes(by, epsilon)) {
+            return std::size_t{};
+        } else {
+            return {};
+        }
+    }
+
+
+    /// Check only the part of the geometry with the number `at`
+    template<typename G, typename R, typename E>
+    bool occludes_at(
+            G const &geometry,
+            R const &by,
+            E const epsilon,
+            std::size_t const at) {
+        if constexpr (IndexedOcclusion<G, R, E>) {
+            return geometry.occludes(by, epsilon, at);
+        } else {
+            return geometry.occludes(by, epsilon);
+        }
+    }
+
+
+    /// The last occluder found for something (normally a light) on this
+    /// thread. A small table is used so that each thread only remembers
+    /// the latest few
+    inline std::optional<std::size_t> &last_occluder(void const *const key) {
+        struct entry {
+            void const *key = nullptr;
+            std::optional<std::size_t> occluder;
+        };
+        thread_local std::array<entry, 64> cache;
+        auto &e = cache[(std::uintptr_t(key) >> 4) % cache.size()];
+        if (e.key != key) {
+            e.key = key;
+            e.occluder.reset();
+        }
+        return e.occluder;
+    }
+
+
+}
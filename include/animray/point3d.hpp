@@ -54,7 +54,7 @@ namespace animray {
         using superclass::print_on;
 
         /// Return the 4 underlying coordinates
-        const array_type &array() const { return superclass::array; }
+        constexpr const array_type &array() const { return superclass::array; }
 
         /// The x coordinate
         value_type x() const {
@@ -23,8 +23,7 @@
 #pragma once
 
 
-#include <animray/matrix.hpp>
-#include <animray/unit-vector.hpp>
+#include <animray/affine-matrix.hpp>
 
 
 namespace animray {
@@ -96,6 +95,34 @@ namespace animray {
             res *= right;
             return res;
         }
+
+        /// Transform a ray by an affine matrix. The start is moved and the
+        /// direction rotated directly, rather than transforming a second
+        /// location along the ray and working out the direction again
+        template<typename MD>
+        ray &operator*=(affine_matrix<MD> const &right) {
+            from = right * from;
+            direction = right.direction(direction);
+            return *this;
+        }
+        template<typename MD>
+        ray operator*(affine_matrix<MD> const &right) const {
+            ray res(*this);
+            res *= right;
+            return res;
+        }
+
+        /// Transform a ray that holds a surface normal. The start is moved by
+        /// `right` and the direction by the transpose of `inverse`, which
+        /// must be the inverse of `right`
+        template<typename MD>
+        ray &transform_normal(
+                affine_matrix<MD> const &right,
+                affine_matrix<MD> const &inverse) {
+            from = right * from;
+            direction = inverse.normal(direction);
+            return *this;
+        }
     };
 
 
@@ -103,9 +130,16 @@ namespace animray {
     ray(point3d<V>, point3d<V>) -> ray<V, point3d<V>>;
 
 
-    /// Output to a stream
+    /// A ray whose ends and direction are kept in Cartesian form so that
+    /// using them never needs a divide
     template<typename D>
-    std::ostream &operator<<(std::ostream &o, animray::ray<D> const &r) {
+    using cartesian_ray = ray<D, cartesian3d<D>, direction3d<D>>;
+
+
+    /// Output to a stream
+    template<typename D, typename F, typename V>
+    std::ostream &
+            operator<<(std::ostream &o, animray::ray<D, F, V> const &r) {
         return o << r.from << " -> " << r.direction;
     }
 
@@ -0,0 +1,97 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/color/brightness.hpp>
+#include <animray/threading/random-generator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+
+namespace animray {
+
+
+    /// How many samples can be spent on a pixel
+    struct sample_budget {
+        /// The number of samples that are always taken
+        std::size_t initial = 4;
+        /// The most samples that will be taken
+        std::size_t maximum = 16;
+        /// More samples are taken while the estimated error in the pixel is
+        /// larger than this. It is in the same units as the samples
+        double threshold = 0.5;
+    };
+
+
+    /**
+     * ## Adaptive sampling
+     *
+     * Average samples for a pixel, taking more only where they disagree.
+     * The `initial` samples are always taken. After that the standard error
+     * of the mean brightness is estimated from the variance of the samples
+     * and, while it is above the threshold, the number of samples is
+     * doubled up to the `maximum`. Doubling keeps the counts to powers of
+     * two when `initial` is one, which suits the Sobol sampler. One sample
+     * can't give an estimate, so it is always followed by a second.
+     *
+     * `sample()` is called once per sample and returns a colour. The
+     * counter based random numbers are moved on to the next sample of the
+     * current pixel before each call.
+     */
+    template<typename F>
+    auto integrate(sample_budget const &budget, F &&sample) {
+        using color_type = decltype(sample());
+        std::size_t const maximum = std::max(budget.maximum, std::size_t{1});
+        std::size_t target =
+                std::clamp(budget.initial, std::size_t{1}, maximum);
+        color_type total{};
+        std::size_t taken{};
+        // Running mean and sum of squared differences (Welford)
+        double mean{}, squares{};
+        while (true) {
+            for (; taken != target; ++taken) {
+                random::at_sample(taken);
+                auto const photons = sample();
+                total += photons;
+                double const b = brightness(photons);
+                double const delta = b - mean;
+                mean += delta / (taken + 1);
+                squares += delta * (b - mean);
+            }
+            if (taken == maximum) {
+                break;
+            } else if (taken > 1) {
+                double const variance = squares / (taken - 1);
+                if (variance <= budget.threshold * budget.threshold * taken) {
+                    break;
+                }
+            }
+            target = std::min(2 * taken, maximum);
+        }
+        total /= taken;
+        return total;
+    }
+
+
+}
@@ -23,8 +23,10 @@
 #pragma once
 
 
+#include <animray/bounce.hpp>
 #include <animray/epsilon.hpp>
 #include <animray/emission.hpp>
+#include <animray/termination.hpp>
 
 #include <optional>
 #include <utility>
@@ -58,6 +60,8 @@ namespace animray {
         light_type light;
         /// Background colour
         color_type background;
+        /// When to stop following paths through the scene
+        path_termination termination;
 
         /// Given a position on the camera film, calculate the colour it should be
         template<typename M, typename S>
@@ -66,18 +70,48 @@ namespace animray {
             return (*this)(observer);
         }
 
-        /// Given a ray work out how much light is returned along it
+        /// Given a ray work out how much light is returned along it. Where
+        /// a surface reflects or transmits light the path is followed on
+        /// from it here rather than by recursing through the surface
         template<typename R>
         color_type operator()(const R &observer) const {
-            std::optional<intersection_type> intersection(geometry.intersects(
-                    observer,
-                    epsilon<typename intersection_type::local_coord_type>));
-            if (intersection) {
-                return color_type(light(observer, intersection.value(), *this))
-                        + emission<color_type>(
-                                observer, intersection.value(), *this);
-            } else {
-                return background;
+            using path_ray = typename with_depth_count<R>::type;
+            path_ray ray{observer};
+            color_type photons{};
+            std::optional<color_type> weight;
+            std::size_t bounces{};
+            auto const add = [&](color_type const &c) {
+                if (weight) {
+                    photons += c * *weight;
+                } else {
+                    photons += c;
+                }
+            };
+            while (true) {
+                std::optional<intersection_type> intersection(
+                        geometry.intersects(
+                                ray,
+                                epsilon<typename intersection_type::
+                                                local_coord_type>));
+                if (not intersection) {
+                    add(background);
+                    return photons;
+                }
+                add(color_type(light(ray, intersection.value(), *this))
+                    + emission<color_type>(ray, intersection.value(), *this));
+                auto next =
+                        bounce<color_type>(ray, intersection.value(), *this);
+                if (not next) {
+                    return photons;
+                }
+                weight = weight ? *weight * next->weight : next->weight;
+                if (not next->ray) {
+                    add(background);
+                    return photons;
+                } else if (not termination.survives(*weight, ++bounces)) {
+                    return photons;
+                }
+                ray = *next->ray;
             }
         }
     };
@@ -43,6 +43,19 @@ namespace animray {
     };
 
 
+    /// Whether light falling on the intersection can change what is seen.
+    /// Where it can't the lights don't need to be worked out at all
+    template<typename I>
+    struct surface_is_lit {
+        static bool const value = true;
+    };
+    /// Whether this particular intersection is lit
+    template<typename I>
+    bool is_lit(I const &) {
+        return surface_is_lit<I>::value;
+    }
+
+
     /// Calls into the relevant surface partial specialisation
     template<typename RI, typename RL, typename C, typename I, typename G>
     C shader(
@@ -23,6 +23,7 @@
 #pragma once
 
 
+#include <animray/bounce.hpp>
 #include <animray/emission.hpp>
 #include <animray/functional/zip.hpp>
 #include <animray/intersection.hpp>
@@ -120,8 +121,50 @@ namespace animray {
     };
 
 
+    /// Bake a transformation into the geometry of the surface
+    template<typename O, typename... S, typename T>
+    auto bake(surface<O, S...> const &s, T const &t) {
+        auto geometry = bake(s.geometry, t);
+        return std::apply(
+                [&](auto const &...p) {
+                    return surface<decltype(geometry), S...>{
+                            std::move(geometry), p...};
+                },
+                s.surfaces);
+    }
+
+
+    namespace detail {
+        /// Layers that don't say whether they are lit or emissive are taken
+        /// to be both
+        template<typename S>
+        constexpr bool layer_is_lit() {
+            if constexpr (requires { S::is_lit; }) {
+                return S::is_lit;
+            } else {
+                return true;
+            }
+        }
+        template<typename S>
+        constexpr bool layer_is_emissive() {
+            if constexpr (requires { S::is_emissive; }) {
+                return S::is_emissive;
+            } else {
+                return true;
+            }
+        }
+    }
+
+
+    /// A surface is lit if any of its layers are
+    template<typename O, typename... S>
+    struct surface_is_lit<intersection<surface<O, S...>>> {
+        static bool const value = (false or ... or detail::layer_is_lit<S>());
+    };
+
+
     /// Specialisation of the surface interaction that will use all of the
-    /// surface layers
+    /// surface layers that are lit
     template<
             typename C,
             typename O,
@@ -137,18 +180,25 @@ namespace animray {
                 const intersection<surface<O, S...>> &intersection,
                 const C &incident,
                 const G &scene) const {
-            return std::apply(
-                    [&](auto... s) {
-                        return (s(observer, light, intersection, incident, scene)
-                                + ...);
-                    },
+            C lit{};
+            auto const add = [&](auto const &s) {
+                using layer_type = std::decay_t<decltype(s)>;
+                if constexpr (detail::layer_is_lit<layer_type>()) {
+                    lit += s(observer, light, intersection, incident, scene);
+                }
+            };
+            std::apply(
+                    [&](auto const &...s) { (add(s), ...); },
                     intersection.surfaces());
+            return lit;
         }
     };
 
 
     /// Specialisation of the surface emjssion that will use all of the surface
-    /// layers
+    /// layers that are emissive. The path carries on from the first layer
+    /// that bounces, any other layers that bounce have their light traced
+    /// here instead
     template<typename C, typename O, typename RI, typename G, typename... S>
     struct surface_emission<C, RI, intersection<surface<O, S...>>, G> {
         surface_emission() = default;
@@ -156,11 +206,66 @@ namespace animray {
                 const RI &observer,
                 const intersection<surface<O, S...>> &intersection,
                 const G &scene) const {
-            return std::apply(
-                    [&](auto... s) {
-                        return (s(C{}, observer, intersection, scene) + ...);
-                    },
+            C light{};
+            auto const emit = [&](auto const &s) {
+                using layer_type = std::decay_t<decltype(s)>;
+                if constexpr (detail::layer_is_emissive<layer_type>()) {
+                    light += s(C{}, observer, intersection, scene);
+                }
+            };
+            std::apply(
+                    [&](auto const &...s) { (emit(s), ...); },
+                    intersection.surfaces());
+            bool followed = false;
+            auto const extra = [&](auto const &s) {
+                using layer_type = std::decay_t<decltype(s)>;
+                if constexpr (bouncing_layer<
+                                      layer_type, C, RI,
+                                      std::decay_t<decltype(intersection)>,
+                                      G>) {
+                    if (followed) {
+                        light += follow(
+                                s.template bounce<C>(
+                                        observer, intersection, scene),
+                                scene);
+                    }
+                    followed = true;
+                }
+            };
+            std::apply(
+                    [&](auto const &...s) { (extra(s), ...); },
+                    intersection.surfaces());
+            return light;
+        }
+    };
+
+
+    /// Specialisation of the surface bounce that carries the path on from
+    /// the first layer that bounces
+    template<typename C, typename O, typename RI, typename G, typename... S>
+    struct surface_bounce<C, RI, intersection<surface<O, S...>>, G> {
+        surface_bounce() = default;
+        std::optional<continuation<C, RI>> operator()(
+                const RI &observer,
+                const intersection<surface<O, S...>> &intersection,
+                const G &scene) const {
+            std::optional<continuation<C, RI>> next;
+            auto const first = [&](auto const &s) {
+                using layer_type = std::decay_t<decltype(s)>;
+                if constexpr (bouncing_layer<
+                                      layer_type, C, RI,
+                                      std::decay_t<decltype(intersection)>,
+                                      G>) {
+                    if (not next) {
+                        next = s.template bounce<C>(
+                                observer, intersection, scene);
+                    }
+                }
+            };
+            std::apply(
+                    [&](auto const &...s) { (first(s), ...); },
                     intersection.surfaces());
+            return next;
         }
     };
 
@@ -23,9 +23,11 @@
 #pragma once
 
 
+#include <animray/maths/pow.hpp>
 #include <animray/surface.hpp>
 
 #include <cmath>
+#include <concepts>
 
 
 namespace animray {
@@ -36,6 +38,8 @@ namespace animray {
     class gloss {
       public:
         static bool const can_occlude = true;
+        static bool const is_lit = true;
+        static bool const is_emissive = false;
 
         /// Default constructor
         gloss() = default;
@@ -59,12 +63,27 @@ namespace animray {
                     + intersection.direction * accuracy(2) * ci};
             auto const costheta(dot(ri, light.direction));
             if (costheta > accuracy{}) {
-                return incident * std::pow(costheta, width);
+                return incident * highlight(costheta);
             } else {
                 return CI();
             }
         }
 
+        /// `costheta` to the power of the width. Whole number widths, which
+        /// are the usual ones, are worked out by repeated squaring. Past a
+        /// few hundred `std::pow` is as quick
+        template<typename D>
+        D highlight(D const costheta) const {
+            if (width >= W{} and width < W{256}) {
+                if constexpr (std::integral<W>) {
+                    return whole_pow(costheta, width);
+                } else if (W(std::uint64_t(width)) == width) {
+                    return whole_pow(costheta, std::uint64_t(width));
+                }
+            }
+            return std::pow(costheta, width);
+        }
+
         /// This material is non-emissive
         template<typename CI, typename RI, typename I, typename G>
         auto operator()(CI const &, RI const &, I const &, G const &) const {
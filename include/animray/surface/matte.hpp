@@ -34,6 +34,8 @@ namespace animray {
     class matte {
       public:
         static bool const can_occlude = true;
+        static bool const is_lit = true;
+        static bool const is_emissive = false;
 
         /// Default constructor
         matte() = default;
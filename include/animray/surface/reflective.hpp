@@ -23,6 +23,7 @@
 #pragma once
 
 
+#include <animray/bounce.hpp>
 #include <animray/epsilon.hpp>
 #include <animray/surface.hpp>
 #include <animray/mixins/depth-count.hpp>
@@ -37,6 +38,8 @@ namespace animray {
     class reflective {
       public:
         static bool const can_occlude = true;
+        static bool const is_lit = false;
+        static bool const is_emissive = false;
 
         /// Default constructor
         reflective() = default;
@@ -49,13 +52,10 @@ namespace animray {
         /// Maximum number of reflective rays
         std::size_t max_depth = 5;
 
-        /// Calculate the light coming from the reflected ray
-        template<typename RI, typename I, typename CI, typename G>
-        CI reflected(
-                const CI &,
-                const RI &observer,
-                const I &intersection,
-                const G &scene) const {
+        /// The reflected ray that the path carries on along
+        template<typename CI, typename RI, typename I, typename G>
+        continuation<CI, RI> bounce(
+                const RI &observer, const I &intersection, const G &) const {
             using accuracy = typename RI::local_coord_type;
             const accuracy ci =
                     -dot(observer.direction, intersection.direction);
@@ -65,11 +65,11 @@ namespace animray {
             typename animray::with_depth_count<RI>::type refray(observer);
             refray.add_count(observer);
             if (refray.depth_count > max_depth) {
-                return scene.background;
+                return {CI(albedo), {}};
             } else {
                 refray.from = intersection.from;
                 refray.direction = ri;
-                return scene(refray);
+                return {CI(albedo), std::move(refray)};
             }
         }
 
@@ -81,14 +81,10 @@ namespace animray {
             return CI();
         }
 
-        /// The specular light is emissive
+        /// The specular light is followed by the path, see `bounce`
         template<typename CI, typename RI, typename I, typename G>
-        CI operator()(
-                const CI &c,
-                const RI &observer,
-                const I &intersection,
-                const G &scene) const {
-            return reflected(c, observer, intersection, scene) * albedo;
+        CI operator()(const CI &, const RI &, const I &, const G &) const {
+            return CI();
         }
     };
 
@@ -21,7 +21,7 @@
 #pragma once
 
 
-#include <animray/mixins/depth-count.hpp>
+#include <animray/bounce.hpp>
 
 
 namespace animray {
@@ -34,6 +34,8 @@ namespace animray {
     class transparent {
       public:
         static bool const can_occlude = false;
+        static bool const is_lit = false;
+        static bool const is_emissive = false;
 
         transparent() = default;
         transparent(C c) : transparency{std::move(c)} {}
@@ -53,23 +55,27 @@ namespace animray {
             return CI();
         }
 
-        /// The light coming through is treated as emissive
+        /// The path carries on through the surface. Once it is too deep the
+        /// background is seen through it unchanged
         template<typename CI, typename RI, typename I, typename G>
-        CI operator()(
-                CI const &,
-                RI const &observer,
-                I const &intersection,
-                G const &scene) const {
+        continuation<CI, RI> bounce(
+                RI const &observer, I const &intersection, G const &) const {
             typename animray::with_depth_count<RI>::type transray(observer);
             transray.add_count(observer);
             if (transray.depth_count > max_depth) {
-                return scene.background;
+                return {CI(1), {}};
             } else {
                 transray.from = intersection.from;
                 transray.direction = observer.direction;
-                return scene(transray) * transparency;
+                return {CI(transparency), std::move(transray)};
             }
         }
+
+        /// The light coming through is followed by the path, see `bounce`
+        template<typename CI, typename RI, typename I, typename G>
+        CI operator()(CI const &, RI const &, I const &, G const &) const {
+            return CI();
+        }
     };
 
 
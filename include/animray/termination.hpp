@@ -0,0 +1,100 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/threading/random-generator.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+
+namespace animray {
+
+
+    namespace detail {
+        /// The largest fraction of any channel that a path still carries
+        template<typename C>
+        double throughput(C const &c) {
+            if constexpr (requires { c.red(); }) {
+                return std::max(
+                        {double(c.red()), double(c.green()),
+                         double(c.blue())});
+            } else {
+                return double(c);
+            }
+        }
+    }
+
+
+    /**
+     * ## Path termination
+     *
+     * Decides when a path through the scene stops being followed before
+     * the surfaces' own maximum depth is reached.
+     *
+     * After `minimum_bounces` a path carries on with a probability equal
+     * to its throughput, and the paths that survive are brightened to
+     * make up for the ones that don't (Russian roulette). This adds noise
+     * but no bias.
+     *
+     * Paths whose throughput falls below the `cutoff` are ended outright.
+     * This is biased, but `for_exposure` gives a cut-off below which a
+     * path can't change the 8 bit pixel it ends up in. The default of zero
+     * turns it off.
+     */
+    struct path_termination {
+        /// Bounces that are always followed
+        std::size_t minimum_bounces = 3;
+        /// Paths carrying less than this fraction of the light are dropped
+        double cutoff = 0;
+
+        /// A cut-off for a scene whose pixels are converted with `to_srgb`
+        /// using the exposure `limit` and where nothing a path can see is
+        /// brighter than `brightest`. Darker paths change a pixel by less
+        /// than half of a step, even where the sRGB curve is steepest
+        static constexpr double
+                for_exposure(double const limit, double const brightest) {
+            return limit / (2 * 255 * 12.92 * brightest);
+        }
+
+        /// Returns false if the path is to be ended after `bounces`
+        /// bounces, otherwise the path carries on with the `weight` given
+        template<typename C>
+        bool survives(C &weight, std::size_t const bounces) const {
+            double const carried = detail::throughput(weight);
+            if (carried < cutoff) {
+                return false;
+            } else if (bounces <= minimum_bounces or carried >= 1) {
+                return true;
+            }
+            double const u = unit_interval<double>(random::counter::e());
+            if (u < carried) {
+                weight /= carried;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    };
+
+
+}
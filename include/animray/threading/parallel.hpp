@@ -0,0 +1,78 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace animray::threading {
+
+
+    /// The number of threads to use when the caller doesn't say
+    inline std::size_t default_threads() {
+        return std::max(
+                std::size_t{1},
+                std::size_t{std::thread::hardware_concurrency()});
+    }
+
+
+    /// Call `fn(task)` for every task number in `[0, tasks)` spread over up
+    /// to `threads` threads. The first exception thrown by any task is
+    /// re-thrown once all of the threads have finished.
+    template<typename Fn>
+    void parallel_for(
+            std::size_t const tasks, std::size_t const threads, Fn &&fn) {
+        std::size_t const workers = std::min(tasks, threads);
+        if (workers <= 1) {
+            for (std::size_t task{}; task != tasks; ++task) { fn(task); }
+            return;
+        }
+        std::atomic<std::size_t> next{};
+        std::atomic<bool> failed{};
+        std::exception_ptr error;
+        std::vector<std::thread> joins;
+        joins.reserve(workers);
+        for (std::size_t worker{}; worker != workers; ++worker) {
+            joins.emplace_back([&]() {
+                try {
+                    for (std::size_t task = next++; task < tasks;
+                         task = next++) {
+                        fn(task);
+                    }
+                } catch (...) {
+                    if (not failed.exchange(true)) {
+                        error = std::current_exception();
+                    }
+                    next = tasks;
+                }
+            });
+        }
+        for (auto &th : joins) { th.join(); }
+        if (error) { std::rethrow_exception(error); }
+    }
+
+
+}
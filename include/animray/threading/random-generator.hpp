@@ -21,6 +21,9 @@
 #pragma once
 
 
+#include <animray/maths/philox.hpp>
+
+#include <array>
 #include <random>
 
 
@@ -44,8 +47,128 @@ namespace animray::random {
     thread_local E engine<E, D>::e{D{}()};
 
 
+    /// The place in the render that random numbers are being drawn for
+    struct sample_location {
+        std::uint32_t frame = {}, x = {}, y = {}, sample = {};
+
+        constexpr bool operator==(sample_location const &) const = default;
+    };
+
+
+    /// The random bits for one dimension of a sample. The same location,
+    /// dimension and seed always give the same bits
+    constexpr std::uint32_t
+            bits(sample_location const &location,
+                 std::uint32_t const dimension,
+                 std::uint32_t const seed = {}) {
+        return philox({location.x, location.y, location.sample,
+                       dimension / 4},
+                      {location.frame, seed})[dimension % 4];
+    }
+
+
+    /**
+     * ## Counter based engine
+     *
+     * A uniform random bit generator whose numbers are worked out from the
+     * location being sampled and how many numbers have been drawn for it
+     * so far (the dimension). It doesn't matter which thread renders a
+     * pixel, or in what order, the numbers are always the same.
+     *
+     * The render loop says which pixel and which of its samples is being
+     * worked out (see `cli_render` and `integrate`), and the cameras which
+     * frame. Nothing else moves the location, so the numbers don't depend
+     * on the camera or on what else the thread has rendered.
+     */
+    class counter_engine {
+        sample_location m_location;
+        std::uint32_t m_dimension = {};
+        /// Each counter gives four numbers, so the last four are kept
+        /// along with which dimensions they are for
+        std::array<std::uint32_t, 4> m_block = {};
+        std::uint32_t m_block_for = ~std::uint32_t{};
+
+      public:
+        using result_type = std::uint32_t;
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type{}; }
+
+        /// The next number for the current sample
+        result_type operator()() {
+            if (m_dimension / 4 != m_block_for) {
+                m_block_for = m_dimension / 4;
+                m_block = philox(
+                        {m_location.x, m_location.y, m_location.sample,
+                         m_block_for},
+                        {m_location.frame, 0});
+            }
+            return m_block[m_dimension++ % 4];
+        }
+        /// Take the next dimension without drawing a number for it. This
+        /// is for samplers that work their values out from the location
+        std::uint32_t dimension() { return m_dimension++; }
+
+        /// Start drawing numbers for a frame
+        void frame(std::uint32_t const f) {
+            m_location.frame = f;
+            restart();
+        }
+        /// Start drawing numbers for a given sample of a pixel
+        void pixel(
+                std::uint32_t const x,
+                std::uint32_t const y,
+                std::uint32_t const sample = {}) {
+            m_location.x = x;
+            m_location.y = y;
+            m_location.sample = sample;
+            restart();
+        }
+        /// Start drawing numbers for a given sample of the current pixel
+        void sample(std::uint32_t const s) {
+            m_location.sample = s;
+            restart();
+        }
+
+        /// Where the numbers are being drawn for
+        sample_location const &location() const { return m_location; }
+
+      private:
+        void restart() {
+            m_dimension = {};
+            m_block_for = ~std::uint32_t{};
+        }
+    };
+
+
+    /// The counter based engine for this thread, in the same form as
+    /// `engine` so that it can be used with `jitter`
+    struct counter {
+        using engine_type = counter_engine;
+
+        thread_local static inline counter_engine e;
+    };
+
+
+    /// Tell the counter based engine which frame is being rendered
+    template<typename F>
+    void at_frame(F const frame) {
+        counter::e.frame(std::uint32_t(frame));
+    }
+    /// Tell the counter based engine which pixel is being sampled
+    template<typename S>
+    void at_pixel(S const x, S const y, std::size_t const sample = {}) {
+        counter::e.pixel(
+                std::uint32_t(x), std::uint32_t(y), std::uint32_t(sample));
+    }
+    /// Tell the counter based engine which sample of the pixel is next
+    inline void at_sample(std::size_t const sample) {
+        counter::e.sample(std::uint32_t(sample));
+    }
+
+
     /// A distribution that returns a sample with ints as parameters
-    template<typename D, typename E = engine<>, int... P>
+    template<typename D, typename E = counter, int... P>
     struct jitter {
         static auto sample() {
             thread_local static D d(P...);
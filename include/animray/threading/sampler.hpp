@@ -0,0 +1,229 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+
+#include <animray/threading/random-generator.hpp>
+
+#include <cmath>
+
+
+namespace animray::random {
+
+
+    /**
+     * # Low discrepancy samplers
+     *
+     * Each sample of a pixel is a point in as many dimensions as the
+     * cameras ask for: the jitter across the pixel is two, the time the
+     * shutter is open is another. Drawing every dimension at random
+     * leaves clumps and gaps between the samples of a pixel. These
+     * sequences spread the samples of a pixel out evenly, so the same noise
+     * needs fewer samples.
+     *
+     * Every pixel uses the same sequence, scrambled differently so that
+     * the error doesn't repeat across the image. The values depend only on
+     * the frame, pixel, sample and dimension, in the same way as the
+     * `counter_engine` whose location they use.
+     *
+     * A sequence has a static `value(location, dimension)` giving a value
+     * in `[0, 1)`. `sampler<T, S>` turns one into something that can be
+     * used in place of `jitter` by the cameras.
+     */
+
+
+    namespace detail {
+        /// Random bits for a pixel that stay the same for all of its samples
+        inline std::uint32_t
+                pixel_hash(sample_location const &l, std::uint32_t const tag) {
+            return philox({l.x, l.y, tag, 0x9e3779b9}, {l.frame, 0})[0];
+        }
+
+        inline std::uint32_t reverse_bits(std::uint32_t x) {
+            x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+            x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+            x = ((x >> 4) & 0x0f0f0f0f) | ((x & 0x0f0f0f0f) << 4);
+            x = ((x >> 8) & 0x00ff00ff) | ((x & 0x00ff00ff) << 8);
+            return (x >> 16) | (x << 16);
+        }
+
+        /// Randomly permute the bits of `x` so that each bit only depends
+        /// on the bits above it (Burley, "Practical hash-based Owen
+        /// scrambling"). Applied to a Sobol point this keeps it well spread
+        /// out, and applied to the sample index it shuffles the order
+        inline std::uint32_t
+                owen_scramble(std::uint32_t x, std::uint32_t const seed) {
+            x = reverse_bits(x);
+            x += seed;
+            x ^= x * 0x6c50b47c;
+            x ^= x * 0xb82f1e52;
+            x ^= x * 0xc7afe638;
+            x ^= x * 0x8d22f6e6;
+            return reverse_bits(x);
+        }
+
+        /// The radical inverse of `i` in base `b`
+        inline double radical_inverse(std::uint32_t i, std::uint32_t const b) {
+            double const inverse = 1.0 / b;
+            double digit = inverse, result = 0;
+            for (; i; i /= b, digit *= inverse) { result += (i % b) * digit; }
+            return result;
+        }
+
+        /// Kensler's hashed permutation of `[0, l)`
+        inline std::uint32_t permute(
+                std::uint32_t i, std::uint32_t const l, std::uint32_t const p) {
+            std::uint32_t w = l - 1;
+            w |= w >> 1;
+            w |= w >> 2;
+            w |= w >> 4;
+            w |= w >> 8;
+            w |= w >> 16;
+            do {
+                i ^= p;
+                i *= 0xe170893d;
+                i ^= p >> 16;
+                i ^= (i & w) >> 4;
+                i ^= p >> 8;
+                i *= 0x0929eb3f;
+                i ^= p >> 23;
+                i ^= (i & w) >> 1;
+                i *= 1 | p >> 27;
+                i *= 0x6935fa69;
+                i ^= (i & w) >> 11;
+                i *= 0x74dcb303;
+                i ^= (i & w) >> 2;
+                i *= 0x9e501cc3;
+                i ^= (i & w) >> 2;
+                i *= 0xc860a3df;
+                i &= w;
+                i ^= i >> 5;
+            } while (i >= l);
+            return (i + p) % l;
+        }
+
+        /// Kensler's hash from an index to `[0, 1)`
+        inline double random_double(std::uint32_t i, std::uint32_t const p) {
+            i ^= p;
+            i ^= i >> 17;
+            i ^= i >> 10;
+            i *= 0xb36534e5;
+            i ^= i >> 12;
+            i ^= i >> 21;
+            i *= 0x93fc4795;
+            i ^= 0xdf6e307f;
+            i ^= i >> 17;
+            i *= 1 | p >> 18;
+            return i * (1.0 / 4294967296.0);
+        }
+    }
+
+
+    /// Owen scrambled Sobol points. The first two Sobol dimensions are
+    /// used for each pair of dimensions, with the sample order shuffled
+    /// separately for each pair. Works best with a power of two samples
+    struct sobol {
+        static double
+                value(sample_location const &l, std::uint32_t const dimension) {
+            std::uint32_t const pair = dimension / 2;
+            std::uint32_t const index =
+                    detail::owen_scramble(l.sample, detail::pixel_hash(l, pair));
+            std::uint32_t point{};
+            if (dimension % 2 == 0) {
+                point = detail::reverse_bits(index);
+            } else {
+                for (std::uint32_t i = index, v = 1u << 31; i;
+                     i >>= 1, v ^= v >> 1) {
+                    if (i & 1) { point ^= v; }
+                }
+            }
+            return unit_interval<double>(detail::owen_scramble(
+                    point, detail::pixel_hash(l, 0x10000 + dimension)));
+        }
+    };
+
+
+    /// Halton points, using a different prime base for each dimension and
+    /// a random shift for each pixel
+    struct halton {
+        static double
+                value(sample_location const &l, std::uint32_t const dimension) {
+            constexpr std::uint32_t primes[] = {
+                    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+            double const v = detail::radical_inverse(
+                                     l.sample, primes[dimension % 16])
+                    + unit_interval<double>(detail::pixel_hash(l, dimension));
+            return v < 1 ? v : v - 1;
+        }
+    };
+
+
+    /// Correlated multi-jittered points (Kensler, "Correlated multi-jittered
+    /// sampling"). Each pair of dimensions is stratified over `N` samples
+    /// both as an `m` by `n` grid and along each axis. After `N` samples a
+    /// new pattern is started
+    template<std::uint32_t N = 16>
+    struct cmj {
+        static double
+                value(sample_location const &l, std::uint32_t const dimension) {
+            constexpr std::uint32_t m = columns(), n = N / m;
+            std::uint32_t const p = detail::pixel_hash(l, dimension / 2)
+                    + l.sample / (m * n);
+            std::uint32_t const s =
+                    detail::permute(l.sample % (m * n), m * n, p * 0x51633e2d);
+            if (dimension % 2 == 0) {
+                std::uint32_t const sy =
+                        detail::permute(s / m, n, p * 0x63d83595);
+                double const jx = detail::random_double(s, p * 0xa399d265);
+                return (s % m + (sy + jx) / n) / m;
+            } else {
+                std::uint32_t const sx =
+                        detail::permute(s % m, m, p * 0xa511e9b3);
+                double const jy = detail::random_double(s, p * 0x711ad6a5);
+                return (s / m + (sx + jy) / m) / n;
+            }
+        }
+
+      private:
+        /// The grid is as close to square as `N` allows
+        static constexpr std::uint32_t columns() {
+            std::uint32_t m = 1;
+            for (std::uint32_t c{1}; c * c <= N; ++c) {
+                if (N % c == 0) { m = c; }
+            }
+            return m;
+        }
+    };
+
+
+    /// Draw the next dimension of the thread's current sample from a low
+    /// discrepancy sequence. Can be used wherever a `jitter` is
+    template<typename T, typename S = sobol>
+    struct sampler {
+        static T sample() {
+            auto &e = counter::e;
+            T const v = T(S::value(e.location(), e.dimension()));
+            return v < T{1} ? v : std::nextafter(T{1}, T{});
+        }
+    };
+
+
+}
@@ -23,13 +23,14 @@
 #include <animray/camera/pinhole.hpp>
 #include <animray/camera/movie.hpp>
 #include <animray/cli/progress.hpp>
-#include <animray/color/srgb.hpp>
+#include <animray/color/srgb-table.hpp>
 #include <animray/intersection.hpp>
 #include <animray/library/lights/block.hpp>
 #include <animray/maths/angles.hpp>
 #include <animray/movable.hpp>
 #include <animray/geometry/collection.hpp>
 #include <animray/geometry/planar/triangle.hpp>
+#include <animray/sampling.hpp>
 #include <animray/scene.hpp>
 
 
@@ -40,8 +41,12 @@ int main(int argc, char const *const argv[]) {
 
     std::size_t const threads =
             args.switch_value('t', std::thread::hardware_concurrency());
-    std::size_t const samples = args.switch_value('s', 2);
+    animray::sample_budget const budget{
+            args.switch_value('i', std::size_t{4}),
+            args.switch_value('s', std::size_t{2}),
+            args.switch_value('n', 0.7)};
     std::size_t const frames = args.switch_value('l', 2);
+    bool const dither = args.switches.contains('D');
 
     /// ## Set up the geometry
     using world = float;
@@ -69,6 +74,8 @@ int main(int argc, char const *const argv[]) {
     auto const scene = animray::scene{
             cube, animray::library::lights::narrow_block<world>,
             animray::rgb<float>{5, 18, 25}};
+    /// Each frame is converted to sRGB once it has been rendered
+    animray::srgb_table<float> const srgb{1.4f * 255};
 
     for (std::size_t frame{}; frame != frames; ++frame) {
         animray::movable<
@@ -82,19 +89,19 @@ int main(int argc, char const *const argv[]) {
         camera(animray::translate<world>(0.0, 0.0, -6));
         camera.instance.frame = frame;
 
-        using film_type = animray::film<animray::rgb<uint8_t>>;
+        using film_type = animray::film<animray::rgb<float>>;
 
         animray::cli_render_frame<film_type>(
                 args, frame, threads,
-                [samples, &scene, &camera](
+                [&budget, &scene, &camera](
                         const film_type::size_type x,
                         const film_type::size_type y) {
-                    animray::rgb<float> photons;
-                    for (std::size_t sample{}; sample != samples; ++sample) {
-                        photons += scene(camera, x, y) /= samples;
-                    }
-                    auto const exposure = 1.4f;
-                    return animray::to_srgb(photons, exposure * 255);
+                    animray::rgb<float> photons = animray::integrate(
+                            budget, [&]() { return scene(camera, x, y); });
+                    return photons;
+                },
+                [&srgb, dither](film_type const &film) {
+                    return animray::to_srgb(film, srgb, dither);
                 });
     }
 
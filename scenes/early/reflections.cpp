@@ -23,7 +23,7 @@
 #include <animray/camera/pinhole.hpp>
 #include <animray/cli/progress.hpp>
 #include <animray/compound.hpp>
-#include <animray/geometry/quadrics/sphere-unit-origin.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
 #include <animray/geometry/collection.hpp>
 #include <animray/intersection.hpp>
 #include <animray/light/ambient.hpp>
@@ -31,6 +31,7 @@
 #include <animray/light/point.hpp>
 #include <animray/maths/angles.hpp>
 #include <animray/movable.hpp>
+#include <animray/sampling.hpp>
 #include <animray/scene.hpp>
 #include <animray/shader.hpp>
 #include <animray/surface/matte.hpp>
@@ -44,23 +45,26 @@ int main(int argc, char const *const argv[]) {
 
     std::size_t const threads =
             args.switch_value('t', std::thread::hardware_concurrency());
-    std::size_t const samples = args.switch_value('s', 6);
+    animray::sample_budget const budget{
+            args.switch_value('i', std::size_t{4}),
+            args.switch_value('s', std::size_t{16}),
+            args.switch_value('n', 0.7)};
 
     using world = double;
     world const aspect = double(args.width) / args.height;
     world const fw = args.width > args.height ? aspect * 0.024 : 0.024;
     world const fh = args.width > args.height ? 0.024 : 0.024 / aspect;
 
-    using gloss_sphere_type = animray::movable<animray::surface<
-            animray::unit_sphere_at_origin<animray::ray<world>>,
-            animray::gloss<world>, animray::matte<animray::rgb<float>>>>;
-    using reflective_sphere_type = animray::movable<animray::surface<
-            animray::unit_sphere_at_origin<animray::ray<world>>,
-            animray::reflective<float>, animray::matte<animray::rgb<float>>>>;
-    using metallic_sphere_type = animray::movable<animray::surface<
-            animray::unit_sphere_at_origin<animray::ray<world>>,
+    using gloss_sphere_type = animray::surface<
+            animray::sphere<animray::ray<world>>, animray::gloss<world>,
+            animray::matte<animray::rgb<float>>>;
+    using reflective_sphere_type = animray::surface<
+            animray::sphere<animray::ray<world>>, animray::reflective<float>,
+            animray::matte<animray::rgb<float>>>;
+    using metallic_sphere_type = animray::surface<
+            animray::sphere<animray::ray<world>>,
             animray::reflective<animray::rgb<float>>,
-            animray::matte<animray::rgb<float>>>>;
+            animray::matte<animray::rgb<float>>>;
     using scene_type = animray::scene<
             animray::compound<
                     reflective_sphere_type, metallic_sphere_type,
@@ -77,32 +81,43 @@ int main(int argc, char const *const argv[]) {
             animray::rgb<float>>;
     scene_type scene;
     scene.background = animray::rgb<float>(20, 70, 100);
+    /// The mirrors allow long paths, which are cut short once they can't
+    /// change the pixel. Nothing is brighter than all of the lights
+    /// together, with the same again for the highlights
+    const float exposure = 1.4f;
+    scene.termination = animray::path_termination{
+            3,
+            animray::path_termination::for_exposure(
+                    exposure * 255, 2 * (50 + 0xa0 + 0x40 + 0x40))};
+    const std::size_t max_depth = 1u << 16;
 
     const world scale(200.0);
     std::get<0>(scene.geometry.instances) =
             reflective_sphere_type{
-                    animray::unit_sphere_at_origin<animray::ray<world>>{}, 0.4f,
+                    animray::sphere<animray::ray<world>>{},
+                    animray::reflective<float>{0.4f, max_depth},
                     animray::rgb<float>(0.5f)}(
                     animray::translate<world>(0.0, 0.0, scale + 1.0))(
                     animray::scale<world>(scale, scale, scale));
     std::get<1>(scene.geometry.instances) = metallic_sphere_type{
-            animray::unit_sphere_at_origin<animray::ray<world>>{},
-            animray::rgb<float>(0, 0.8f, 0.8f),
+            animray::sphere<animray::ray<world>>{},
+            animray::reflective<animray::rgb<float>>{
+                    animray::rgb<float>(0, 0.8f, 0.8f), max_depth},
             animray::rgb<float>(
                     0, 0.9f, 0.9f)}(animray::translate<world>(-1.0, -1.0, 0.0));
     std::get<2>(scene.geometry.instances)
             .insert(gloss_sphere_type{
-                    animray::unit_sphere_at_origin<animray::ray<world>>{},
+                    animray::sphere<animray::ray<world>>{},
                     10.0f, animray::rgb<float>(1.0, 0.25, 0.5)}(
                     animray::translate<world>(1.0, -1.0, 0.0)));
     std::get<2>(scene.geometry.instances)
             .insert(gloss_sphere_type{
-                    animray::unit_sphere_at_origin<animray::ray<world>>{},
+                    animray::sphere<animray::ray<world>>{},
                     20.0f, animray::rgb<float>(0.25, 1.0, 0.5)}(
                     animray::translate<world>(-1.0, 1.0, 0.0)));
     std::get<2>(scene.geometry.instances)
             .insert(gloss_sphere_type{
-                    animray::unit_sphere_at_origin<animray::ray<world>>{},
+                    animray::sphere<animray::ray<world>>{},
                     50.0f, animray::rgb<float>(0.25, 0.5, 1.0)}(
                     animray::translate<world>(1.0, 1.0, 0.0)));
 
@@ -138,13 +153,10 @@ int main(int argc, char const *const argv[]) {
 
     animray::cli_render<film_type>(
             args, threads,
-            [samples, &scene, &camera](
+            [&budget, &scene, &camera, exposure](
                     const film_type::size_type x, const film_type::size_type y) {
-                animray::rgb<float> photons;
-                for (std::size_t sample{}; sample != samples; ++sample) {
-                    photons += scene(camera, x, y) /= samples;
-                }
-                const float exposure = 1.4f;
+                animray::rgb<float> photons = animray::integrate(
+                        budget, [&]() { return scene(camera, x, y); });
                 photons /= exposure;
                 return animray::rgb<uint8_t>(
                         uint8_t(photons.red() > 255 ? 255 : photons.red()),
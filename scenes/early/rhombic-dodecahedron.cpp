@@ -23,7 +23,7 @@
 #include <animray/camera/pinhole.hpp>
 #include <animray/camera/movie.hpp>
 #include <animray/cli/progress.hpp>
-#include <animray/color/srgb.hpp>
+#include <animray/color/srgb-table.hpp>
 #include <animray/intersection.hpp>
 #include <animray/library/lights/block.hpp>
 #include <animray/line.hpp>
@@ -31,6 +31,7 @@
 #include <animray/movable.hpp>
 #include <animray/geometry/collection.hpp>
 #include <animray/geometry/planar/triangle.hpp>
+#include <animray/sampling.hpp>
 #include <animray/scene.hpp>
 #include <animray/surface.hpp>
 #include <animray/surface/gloss.hpp>
@@ -46,12 +47,16 @@ int main(int argc, char const *const argv[]) {
 
     std::size_t const threads =
             args.switch_value('t', std::thread::hardware_concurrency());
-    std::size_t const samples = args.switch_value('s', 2);
+    animray::sample_budget const budget{
+            args.switch_value('i', std::size_t{4}),
+            args.switch_value('s', std::size_t{2}),
+            args.switch_value('n', 0.7)};
     std::size_t const frames = args.switch_value('l', 2);
     std::size_t const start_frame = args.switch_value('L', 0);
     std::size_t const depth = args.switch_value('d', 5);
     std::size_t const gloss = args.switch_value('g', 1000);
     float const exposure = args.switch_value('e', 1.4f);
+    bool const dither = args.switches.contains('D');
     std::size_t const strip_lights = args.switch_value('S', 3);
 
     /// ## Set up the geometry
@@ -118,6 +123,8 @@ int main(int argc, char const *const argv[]) {
                     animray::reflective{world(0.8), depth},
                     animray::gloss{gloss}},
             lights, animray::rgb<float>{0, 0, 0}};
+    /// Each frame is converted to sRGB once it has been rendered
+    animray::srgb_table<float> const srgb{exposure * 255};
 
     for (auto frame{start_frame}; frame != frames; ++frame) {
         animray::movable<
@@ -133,18 +140,19 @@ int main(int argc, char const *const argv[]) {
                 0.0, 0.0, -2.2 - (std::cos(orbit_position) + 1) * 3.9));
         camera.instance.frame = frame;
 
-        using film_type = animray::film<animray::rgb<uint8_t>>;
+        using film_type = animray::film<animray::rgb<float>>;
 
         animray::cli_render_frame<film_type>(
                 args, frame, threads,
-                [samples, &scene, &camera, exposure](
+                [&budget, &scene, &camera](
                         const film_type::size_type x,
                         const film_type::size_type y) {
-                    animray::rgb<float> photons;
-                    for (std::size_t sample{}; sample != samples; ++sample) {
-                        photons += scene(camera, x, y) /= samples;
-                    }
-                    return animray::to_srgb(photons, exposure * 255);
+                    animray::rgb<float> photons = animray::integrate(
+                            budget, [&]() { return scene(camera, x, y); });
+                    return photons;
+                },
+                [&srgb, dither](film_type const &film) {
+                    return animray::to_srgb(film, srgb, dither);
                 });
     }
 
@@ -32,6 +32,7 @@
 #include <animray/light/point.hpp>
 #include <animray/maths/angles.hpp>
 #include <animray/movable.hpp>
+#include <animray/sampling.hpp>
 #include <animray/scene.hpp>
 #include <animray/shader.hpp>
 #include <animray/surface/matte.hpp>
@@ -45,7 +46,10 @@ int main(int argc, char const *const argv[]) {
 
     std::size_t const threads =
             args.switch_value('t', std::thread::hardware_concurrency());
-    std::size_t const samples = args.switch_value('s', 6);
+    animray::sample_budget const budget{
+            args.switch_value('i', std::size_t{4}),
+            args.switch_value('s', std::size_t{16}),
+            args.switch_value('n', 0.7)};
     std::size_t const spheres = args.switch_value('c', 20);
 
     using world = double;
@@ -138,12 +142,10 @@ int main(int argc, char const *const argv[]) {
 
     animray::cli_render<film_type>(
             args, threads,
-            [samples, &scene, &camera](
+            [&budget, &scene, &camera](
                     const film_type::size_type x, const film_type::size_type y) {
-                animray::rgb<float> photons;
-                for (std::size_t sample{}; sample != samples; ++sample) {
-                    photons += scene(camera, x, y) /= samples;
-                }
+                animray::rgb<float> photons = animray::integrate(
+                        budget, [&]() { return scene(camera, x, y); });
                 const float exposure = 1.4f;
                 photons /= exposure;
                 return animray::rgb<uint8_t>(
@@ -29,6 +29,7 @@
 #include <animray/movable.hpp>
 #include <animray/geometry/collection.hpp>
 #include <animray/geometry/planar/triangle.hpp>
+#include <animray/sampling.hpp>
 #include <animray/scene.hpp>
 
 
@@ -39,7 +40,10 @@ int main(int argc, char const *const argv[]) {
 
     std::size_t const threads =
             args.switch_value('t', std::thread::hardware_concurrency());
-    std::size_t const samples = args.switch_value('s', 1);
+    animray::sample_budget const budget{
+            args.switch_value('i', std::size_t{4}),
+            args.switch_value('s', std::size_t{1}),
+            args.switch_value('n', 0.7)};
     /// Convert `frames` to an actual frame count instead of scaling value
     std::size_t const frames = args.switch_value('T', 2);
 
@@ -90,13 +94,11 @@ int main(int argc, char const *const argv[]) {
 
         animray::cli_render_frame<film_type>(
                 args, frame, threads,
-                [samples, &scene, &camera](
+                [&budget, &scene, &camera](
                         const film_type::size_type x,
                         const film_type::size_type y) {
-                    animray::rgb<float> photons;
-                    for (std::size_t sample{}; sample != samples; ++sample) {
-                        photons += scene(camera, x, y) /= samples;
-                    }
+                    animray::rgb<float> photons = animray::integrate(
+                            budget, [&]() { return scene(camera, x, y); });
                     const float exposure = 1.4f;
                     photons /= exposure;
                     return animray::rgb<uint8_t>(
@@ -21,7 +21,11 @@
 #include <animray/cli/main.hpp>
 #include <animray/color/hsl.hpp>
 #include <animray/formats/targa.hpp>
+#include <animray/geometry/heightfield.hpp>
 #include <animray/maths/angles.hpp>
+#include <animray/maths/cross.hpp>
+#include <animray/maths/dot.hpp>
+#include <animray/ray.hpp>
 #include <animray/threading/random-generator.hpp>
 #include <iostream>
 
@@ -128,10 +132,62 @@ int main(int argc, char const *const argv[]) {
                             return animray::luma<uint8_t>(heights[x][y] * 255);
                         }});
         break;
+    case 2: {
+        /// Look at the terrain from above one corner with the sun low down
+        /// on the opposite side. The heights are raised so that they are in
+        /// proportion to the size of the map
+        using ray = animray::ray<float>;
+        float const relief = std::min(args.width, args.height) / 8.0f;
+        animray::heightfield<ray> const terrain{animray::film<float>{
+                args.width, args.height,
+                [&heights, relief](auto const x, auto const y) {
+                    return heights[x][y] * relief;
+                }}};
+        using point = animray::point3d<float>;
+        point const centre{args.width / 2.0f, args.height / 2.0f, 0.0f};
+        point const eye{
+                -0.2f * args.width, -0.2f * args.height,
+                0.6f * std::max(args.width, args.height)};
+        animray::unit_vector<float> const sun{point{0.8f, 0.6f, 0.5f}};
+        point const forward{(centre - eye).unit()};
+        point const right{cross(forward, point{0, 0, 1}).unit()};
+        auto const up = cross(right, forward);
+        auto const ambient = animray::luma<uint8_t>{30};
+        animray::targa(
+                args.output_filename,
+                animray::film<animray::luma<uint8_t>>{
+                        args.width, args.height,
+                        [&](auto const x, auto const y) {
+                            auto const sx = (x + 0.5f) / args.width - 0.5f;
+                            auto const sy = 0.5f - (y + 0.5f) / args.height;
+                            auto const aspect =
+                                    float(args.width) / args.height;
+                            ray const r{
+                                    eye,
+                                    eye + forward + right * (sx * aspect)
+                                            + up * sy};
+                            auto const hit = terrain.intersects(r, 1e-4f);
+                            if (not hit) {
+                                return animray::luma<uint8_t>{0};
+                            }
+                            ray const light{
+                                    hit->from, hit->from + sun * 1.0f};
+                            auto const costheta =
+                                    dot(sun, hit->direction);
+                            if (costheta <= 0
+                                or terrain.occludes(light, 1e-3f)) {
+                                return ambient;
+                            }
+                            return animray::luma<uint8_t>(
+                                    30 + 225 * costheta);
+                        }});
+        break;
+    }
     default:
         std::cerr << "Unknown format number " << format << "options are:\n";
         std::cerr << "0 -- False colour HSL\n";
         std::cerr << "1 -- Grayscale matte\n";
+        std::cerr << "2 -- Shaded relief ray traced from the heights\n";
     }
 
     return 0;
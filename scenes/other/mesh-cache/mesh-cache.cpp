@@ -0,0 +1,103 @@
+/*
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/cli/main.hpp>
+#include <animray/formats/mesh-cache.hpp>
+#include <animray/formats/obj.hpp>
+#include <animray/formats/ply.hpp>
+#include <animray/ray.hpp>
+
+#include <chrono>
+#include <iostream>
+
+
+namespace {
+    template<typename D, typename V, typename N>
+    void convert(
+            std::filesystem::path const &in,
+            std::filesystem::path const &out,
+            std::size_t const threads) {
+        using mesh_type = animray::mesh<animray::ray<D>, D, V, N>;
+        auto const started = std::chrono::steady_clock::now();
+        auto const mesh = in.extension() == ".ply"
+                ? animray::load_ply<mesh_type>(in, threads)
+                : animray::load_obj<mesh_type>(in, threads);
+        auto const loaded = std::chrono::steady_clock::now();
+        std::cout << "Loaded " << mesh.vertices().size() << " vertices and "
+                  << mesh.faces().size() << " triangles in "
+                  << std::chrono::duration<double>(loaded - started).count()
+                  << "s" << std::endl;
+
+        animray::save_mesh_cache(out, mesh);
+        auto const saved = std::chrono::steady_clock::now();
+        std::cout << "Saved " << out << " in "
+                  << std::chrono::duration<double>(saved - loaded).count()
+                  << "s" << std::endl;
+
+        auto const check = animray::load_mesh_cache<mesh_type>(out);
+        std::cout << "Reloaded " << check.faces().size() << " triangles in "
+                  << std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - saved)
+                             .count()
+                  << "s" << std::endl;
+    }
+}
+
+
+int main(int argc, char const *const argv[]) {
+    auto const args = animray::cli::arguments{argc, argv, "mesh.amc", 0, 0};
+
+    auto const input = args.switches.find('i');
+    if (input == args.switches.end() or not input->second) {
+        std::cerr << "Give the OBJ or PLY file to convert with -i"
+                  << std::endl;
+        return 1;
+    }
+    std::size_t const threads =
+            args.switch_value('t', animray::threading::default_threads());
+
+    auto const bits = args.switch_value('q', 0);
+    if (args.switches.contains('d') and args.switches.contains('q')) {
+        std::cerr << "Double precision positions can't be quantised"
+                  << std::endl;
+        return 1;
+    } else if (args.switches.contains('d')) {
+        convert<double, animray::exact_positions<double>,
+                animray::exact_normals<double>>(
+                input->second, args.output_filename, threads);
+    } else if (bits == 16) {
+        convert<float, animray::quantised_positions<float, 16>,
+                animray::octahedral_normals<float>>(
+                input->second, args.output_filename, threads);
+    } else if (bits == 21) {
+        convert<float, animray::quantised_positions<float, 21>,
+                animray::octahedral_normals<float>>(
+                input->second, args.output_filename, threads);
+    } else if (bits == 0) {
+        convert<float, animray::exact_positions<float>,
+                animray::exact_normals<float>>(
+                input->second, args.output_filename, threads);
+    } else {
+        std::cerr << "Quantised positions must be 16 or 21 bits" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/camera/flat-jitter.hpp>
+#include <animray/camera/ortho.hpp>
+#include <animray/camera/pinhole.hpp>
+#include <animray/maths/angles.hpp>
+#include <animray/movable.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using point_type = animray::point3d<double>;
+
+
+    /// Check that the batch holds the same rays as the camera makes one at
+    /// a time
+    template<typename C>
+    void check_batch(auto check, C const &camera) {
+        animray::ray_batch<double> batch;
+        camera.fill(batch, 3, 5, 7, 4);
+        check(batch.size()) == 28u;
+        for (std::size_t row{}; row != 4; ++row) {
+            for (std::size_t col{}; col != 7; ++col) {
+                auto const expected = camera(3 + col, 5 + row);
+                auto const found = batch[row * 7 + col];
+                animray::check_close(
+                        check, point_type(found.from), expected.from, 1e-9);
+                animray::check_close(
+                        check, point_type(found.direction.x(),
+                                          found.direction.y(),
+                                          found.direction.z()),
+                        point_type(expected.direction), 1e-9);
+            }
+        }
+    }
+
+
+    auto const pin = suite.test("pinhole batch", [](auto check) {
+        animray::pinhole_camera<ray_type> const camera{
+                0.036, 0.024, 30, 20, 0.05, 0.5};
+        check_batch(check, camera);
+
+        animray::movable<animray::pinhole_camera<ray_type>, ray_type> moved{
+                0.036, 0.024, 30, 20, 0.05};
+        moved(animray::rotate_x<double>(-65_deg))(
+                animray::translate<double>(0.0, -4.0, -40));
+        check_batch(check, moved);
+    });
+
+
+    auto const ortho = suite.test("ortho batch", [](auto check) {
+        animray::movable<animray::ortho_camera<ray_type>, ray_type> camera{
+                4.0, 3.0, 40, 30, -9.0, 1.0};
+        camera(animray::rotate_y<double>(30_deg))(
+                animray::translate<double>(1, 2, 3));
+        check_batch(check, camera);
+    });
+
+
+    auto const jitter = suite.test("jitter batch", [](auto check) {
+        animray::flat_camera<double> const flat{4.0, 2.0, 40, 20};
+        animray::flat_jitter_camera<double> const jittered{4.0, 2.0, 40, 20};
+        std::array<double, 12> x, y, jx, jy;
+        flat.positions(10, 10, 4, 3, x, y);
+        jittered.positions(10, 10, 4, 3, jx, jy);
+        for (std::size_t i{}; i != 12; ++i) {
+            auto const pixel = flat(10 + i % 4, 10 + i / 4);
+            animray::check_close(check, x[i], pixel.x, 1e-12);
+            animray::check_close(check, y[i], pixel.y, 1e-12);
+            check(jx[i]) >= x[i];
+            check(jx[i]) < x[i] + flat.pixel_width();
+            check(jy[i]) >= y[i];
+            check(jy[i]) < y[i] + flat.pixel_height();
+        }
+    });
+
+
+}
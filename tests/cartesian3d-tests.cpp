@@ -0,0 +1,131 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/affine.hpp>
+#include <animray/functional/traits.hpp>
+#include <animray/geometry/planar/triangle.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
+#include <animray/maths/cross.hpp>
+#include <animray/ray.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    static_assert(animray::Regular<animray::cartesian3d<float>>);
+    static_assert(animray::Regular<animray::cartesian3d<double>>);
+    static_assert(animray::Regular<animray::direction3d<float>>);
+    static_assert(animray::Regular<animray::direction3d<double>>);
+
+
+    auto const c = suite.test("conversion", [](auto check) {
+        animray::point3d<double> const h(2, 4, 6, 2);
+        animray::cartesian3d<double> const p{h};
+        check(p) == animray::cartesian3d{1.0, 2.0, 3.0};
+        check(animray::point3d<double>(p)) == h;
+
+        animray::unit_vector<double> const u{animray::point3d(0.0, 3.0, 4.0)};
+        animray::direction3d<double> const d{u};
+        check(d.x()) == 0.0;
+        animray::check_close(check, d.y(), 0.6, 1e-12);
+        animray::check_close(check, d.z(), 0.8, 1e-12);
+        check(animray::direction3d<double>(animray::unit_vector<double>(d)))
+                == d;
+    });
+
+
+    auto const a = suite.test("arithmetic", [](auto check) {
+        animray::cartesian3d<int> const x{1, 0, 0}, y{0, 1, 0}, z{0, 0, 1};
+        check(x + y) == animray::cartesian3d{1, 1, 0};
+        check(x - z) == animray::cartesian3d{1, 0, -1};
+        check(-y) == animray::cartesian3d{0, -1, 0};
+        check(x * 3) == animray::cartesian3d{3, 0, 0};
+        check(cross(x, y)) == z;
+        check(dot(x + y, y + z)) == 1;
+        check(animray::cartesian3d{3, 4, 12}.magnitude()) == 13;
+
+        animray::direction3d<double> const d{
+                animray::cartesian3d{0.0, 0.0, -2.0}};
+        check(d) == animray::direction3d<double>(0, 0, -1);
+        check(d * 2.0) == animray::cartesian3d{0.0, 0.0, -2.0};
+    });
+
+
+    auto const m = suite.test("matrix", [](auto check) {
+        animray::cartesian3d const p{1.0, 2.0, 3.0};
+        check(animray::translate<double>(1, 1, 1).forward() * p)
+                == animray::cartesian3d{2.0, 3.0, 4.0};
+        animray::matrix<double> projective;
+        projective[3][3] = 2;
+        check(projective * p) == animray::cartesian3d{0.5, 1.0, 1.5};
+
+        animray::cartesian_ray<double> r{
+                p, animray::cartesian3d{1.0, 2.0, 5.0}};
+        r *= animray::scale<double>(2, 2, 2).first;
+        check(r.from) == animray::cartesian3d{2.0, 4.0, 6.0};
+        check(r.direction) == animray::direction3d<double>(0, 0, 1);
+    });
+
+
+    auto const g = suite.test("geometry", [](auto check) {
+        using homogeneous = animray::ray<double>;
+        using cartesian = animray::cartesian_ray<double>;
+        animray::point3d<double> const one(0, 0, 0), two(5, 0, 0),
+                three(0, 3, 0);
+        animray::triangle<homogeneous> const th{one, two, three};
+        animray::triangle<cartesian> const tc{one, two, three};
+        animray::sphere<homogeneous> const sh{{1, 1, -1}, 1.5};
+        animray::sphere<cartesian> const sc{{1, 1, -1}, 1.5};
+        for (double x{-1}; x < 6; x += 0.5) {
+            animray::point3d<double> const from(x, 1, 4), to(1, x / 2, 0);
+            homogeneous const h{from, to};
+            cartesian const c{
+                    animray::cartesian3d<double>{from},
+                    animray::cartesian3d<double>{to}};
+
+            auto const hit_h = th.intersects(h, 1e-9);
+            auto const hit_c = tc.intersects(c, 1e-9);
+            check(hit_h.has_value()) == hit_c.has_value();
+            if (hit_h and hit_c) {
+                animray::check_close(
+                        check, hit_h->from,
+                        animray::point3d<double>(hit_c->from));
+                check(animray::direction3d<double>(hit_h->direction))
+                        == hit_c->direction;
+            }
+
+            auto const sphere_h = sh.intersects(h);
+            auto const sphere_c = sc.intersects(c);
+            check(sphere_h.has_value()) == sphere_c.has_value();
+            if (sphere_h and sphere_c) {
+                animray::check_close(
+                        check, sphere_h->from,
+                        animray::point3d<double>(sphere_c->from));
+            }
+        }
+    });
+
+
+}
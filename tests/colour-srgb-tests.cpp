@@ -0,0 +1,73 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <animray/color/srgb-table.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    auto const tl = suite.test("table levels", [](auto check) {
+        animray::srgb_table<float> const table{255};
+        for (float const v : {0.0f, 0.5f, 10.0f, 64.0f, 128.0f, 255.0f}) {
+            float const level = animray::srgb_channel_level(v, 255.0f);
+            check(std::abs(table.level(v) - level) < 0.01f) == true;
+        }
+        /// Out of range values are clamped
+        check(table(-1.0f)) == 0;
+        check(table(1000.0f))
+                == animray::apply_srgb_channel_gamma(255.0f, 255.0f);
+        /// Colours go channel by channel
+        auto const c = table(animray::rgb<float>{0, 64, 255});
+        check(c.red()) == table(0.0f);
+        check(c.green()) == table(64.0f);
+        check(c.blue()) == table(255.0f);
+    });
+
+
+    auto const dt = suite.test("dithering", [](auto check) {
+        animray::srgb_table<float> const table{255};
+        /// Across a dither cell the average is the level before truncation
+        float const v = 100.0f;
+        double total{};
+        for (std::size_t x{}; x != 8; ++x) {
+            for (std::size_t y{}; y != 8; ++y) { total += table(v, x, y); }
+        }
+        check(std::abs(total / 64 - table.level(v)) < 1.0 / 64) == true;
+    });
+
+
+    auto const fp = suite.test("film", [](auto check) {
+        animray::film<animray::rgb<float>> image{
+                3, 2, animray::rgb<float>{50, 100, 200}};
+        animray::srgb_table<float> const table{255};
+        auto const plain = animray::to_srgb(image, table);
+        check(plain.width()) == 3u;
+        check(plain.height()) == 2u;
+        check(plain[2][1].green()) == table(100.0f);
+        auto const dithered = animray::to_srgb(image, table, true);
+        check(dithered[1][1].red()) == table(50.0f, 1, 1);
+    });
+
+
+}
@@ -0,0 +1,333 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/formats/mesh-cache.hpp>
+#include <animray/formats/obj.hpp>
+#include <animray/formats/ply.hpp>
+#include <animray/geometry/mesh.hpp>
+#include <animray/ray.hpp>
+#include <felspar/test.hpp>
+
+#include <sstream>
+#include <string>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using mesh_type = animray::mesh<animray::ray<float>>;
+    using vertex_type = mesh_type::vertex_type;
+
+
+    auto const o = suite.test("obj", [](auto check) {
+        auto const m = animray::parse_obj<mesh_type>(
+                "# A square and a triangle\n"
+                "o square\n"
+                "v 0 0 0\n"
+                "v 1 0 0\r\n"
+                "v 1 1 0 1.0\n"
+                "  v\t0 +1 0\n"
+                "vt 0 0\n"
+                "f 1/1 2/1 3/1 4/1\n"
+                "v 2 2 2\n"
+                "f -1 -2 -3 # relative\n");
+        check(m.vertices().size()) == 5u;
+        check(m.vertices()[3]) == vertex_type{0, 1, 0};
+        check(m.vertices()[4]) == vertex_type{2, 2, 2};
+        check(m.normals().size()) == 0u;
+        check(m.faces().size()) == 3u;
+        check(m.bounds().upper) == vertex_type{2, 2, 2};
+    });
+
+
+    auto const c = suite.test("obj chunks", [](auto check) {
+        std::string text;
+        std::size_t const side = 200;
+        for (std::size_t y{}; y != side; ++y) {
+            for (std::size_t x{}; x != side; ++x) {
+                text += "v " + std::to_string(x) + " " + std::to_string(y)
+                        + " 0\n";
+                if (x and y) {
+                    text += "f -1 -2 " + std::to_string(1 + x + (y - 1) * side)
+                            + " -" + std::to_string(side + 1) + "\n";
+                }
+            }
+        }
+        auto const one = animray::parse_obj<mesh_type>(text, 1);
+        auto const many = animray::parse_obj<mesh_type>(text, 8);
+        check(one.vertices().size()) == side * side;
+        check(one.faces().size()) == 2 * (side - 1) * (side - 1);
+        check(many.faces().size()) == one.faces().size();
+        check(std::equal(
+                      one.vertices().begin(), one.vertices().end(),
+                      many.vertices().begin()))
+                .is_truthy();
+        check(std::equal(
+                      one.faces().begin(), one.faces().end(),
+                      many.faces().begin()))
+                .is_truthy();
+    });
+
+
+    auto const n = suite.test("obj normals", [](auto check) {
+        auto const m = animray::parse_obj<mesh_type>(
+                "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+                "vn 0 0 1\nvn 0 0 -1\n"
+                "f 1//1 2//1 3//1\n"
+                "f 2//2 4//2 3//2\n");
+        check(m.vertices().size()) == 6u;
+        check(m.normals().size()) == 6u;
+        check(m.normals()[4]) == vertex_type{0, 0, -1};
+        check(m.vertices()[4]) == m.vertices()[1];
+    });
+
+
+    auto const e = suite.test("obj errors", [](auto check) {
+        check([]() {
+            animray::parse_obj<mesh_type>("v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+        }).throws(felspar::overflow_error<std::size_t>{
+                "OBJ face refers to a vertex past the last"});
+        check([]() {
+            animray::parse_obj<mesh_type>("v 0 0 0\nv 1 0 0\nf 1 2\n");
+        }).throws(felspar::underflow_error<std::size_t>{
+                "OBJ faces need at least three vertices"});
+        check([]() {
+            animray::parse_obj<mesh_type>("v 0 zero 0\n");
+        }).throws(std::runtime_error{"Malformed number in OBJ file"});
+    });
+
+
+    /// Build a binary PLY file
+    struct ply_writer {
+        std::endian order;
+        std::vector<std::byte> bytes;
+
+        ply_writer(std::endian o, std::string_view header) : order{o} {
+            for (auto const c : header) { bytes.push_back(std::byte(c)); }
+        }
+
+        template<typename T>
+        ply_writer &operator<<(T const value) {
+            auto raw = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+            if (order != std::endian::native) {
+                std::reverse(raw.begin(), raw.end());
+            }
+            bytes.insert(bytes.end(), raw.begin(), raw.end());
+            return *this;
+        }
+    };
+
+
+    auto const pt = suite.test("ply triangles", [](auto check) {
+        ply_writer ply{
+                std::endian::little,
+                "ply\n"
+                "format binary_little_endian 1.0\n"
+                "comment Two triangles\n"
+                "element vertex 4\n"
+                "property float x\n"
+                "property float y\n"
+                "property float z\n"
+                "property uchar red\n"
+                "element face 2\n"
+                "property list uchar int vertex_indices\n"
+                "end_header\n"};
+        ply << 0.0f << 0.0f << 0.0f << std::uint8_t(1);
+        ply << 1.0f << 0.0f << 0.0f << std::uint8_t(2);
+        ply << 1.0f << 1.0f << 0.0f << std::uint8_t(3);
+        ply << 0.0f << 1.0f << 2.0f << std::uint8_t(4);
+        ply << std::uint8_t(3) << 0 << 1 << 2;
+        ply << std::uint8_t(3) << 0 << 2 << 3;
+        auto const m = animray::parse_ply<mesh_type>(ply.bytes);
+        check(m.vertices().size()) == 4u;
+        check(m.vertices()[3]) == vertex_type{0, 1, 2};
+        check(m.normals().size()) == 0u;
+        check(m.faces().size()) == 2u;
+    });
+
+
+    auto const pp = suite.test("ply polygons", [](auto check) {
+        ply_writer ply{
+                std::endian::big,
+                "ply\n"
+                "format binary_big_endian 1.0\n"
+                "element vertex 5\n"
+                "property double x\n"
+                "property double y\n"
+                "property double z\n"
+                "property float nx\n"
+                "property float ny\n"
+                "property float nz\n"
+                "element face 2\n"
+                "property list uchar uint vertex_index\n"
+                "property short flags\n"
+                "element edge 1\n"
+                "property list uchar int vertices\n"
+                "end_header\n"};
+        for (int v{}; v != 5; ++v) {
+            ply << double(v) << double(v * v) << 0.0;
+            ply << 0.0f << 0.0f << 1.0f;
+        }
+        ply << std::uint8_t(4) << 0u << 1u << 2u << 3u << std::int16_t(7);
+        ply << std::uint8_t(3) << 2u << 3u << 4u << std::int16_t(7);
+        ply << std::uint8_t(2) << 0 << 1;
+        auto const m = animray::parse_ply<mesh_type>(ply.bytes, 4);
+        check(m.vertices().size()) == 5u;
+        check(m.vertices()[4]) == vertex_type{4, 16, 0};
+        check(m.normals().size()) == 5u;
+        check(m.normals()[2]) == vertex_type{0, 0, 1};
+        check(m.faces().size()) == 3u;
+
+        check([&]() {
+            ply.bytes.pop_back();
+            animray::parse_ply<mesh_type>(ply.bytes);
+        }).throws(std::runtime_error{"The PLY file is truncated"});
+    });
+
+
+    auto const pm = suite.test("ply misaligned", [](auto check) {
+        /// After the octagon every record that the parallel pass reads
+        /// for the second block is misaligned, and the first index
+        /// there decodes as negative
+        std::size_t const triangles = 1 << 16;
+        ply_writer ply{
+                std::endian::little,
+                "ply\n"
+                "format binary_little_endian 1.0\n"
+                "element vertex 201\n"
+                "property float x\n"
+                "property float y\n"
+                "property float z\n"
+                "element face 65537\n"
+                "property int flags\n"
+                "property list uchar int vertex_indices\n"
+                "end_header\n"};
+        for (int v{}; v != 201; ++v) { ply << float(v) << 0.0f << 0.0f; }
+        ply << 0x300 << std::uint8_t(8);
+        for (int c{}; c != 8; ++c) { ply << c; }
+        for (std::size_t f{}; f != triangles; ++f) {
+            ply << 0x300 << std::uint8_t(3) << 200 << 1 << 2;
+        }
+        auto const m = animray::parse_ply<mesh_type>(ply.bytes, 2);
+        check(m.faces().size()) == triangles + 6;
+
+        check([]() {
+            ply_writer ply{
+                    std::endian::little,
+                    "ply\n"
+                    "format binary_little_endian 1.0\n"
+                    "element vertex 1\n"
+                    "end_header\n"};
+            animray::parse_ply<mesh_type>(ply.bytes);
+        }).throws(std::runtime_error{"PLY vertices must have x, y and z"});
+    });
+
+
+    auto const mc = suite.test("mesh cache", [](auto check) {
+        auto const original = animray::parse_obj<mesh_type>(
+                "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nv 0 0 1\n"
+                "vn 0 0 1\nvn 0 1 0\n"
+                "f 1//1 2//1 3//1\nf 2//1 4//1 3//1\nf 1//2 2//2 5//2\n");
+        std::stringstream out;
+        auto const size = animray::write_mesh_cache(out, original);
+        auto const text = out.str();
+        check(text.size()) == size;
+
+        auto const blob = std::make_shared<std::vector<std::byte>>(size);
+        std::memcpy(blob->data(), text.data(), size);
+        auto const header = animray::read_mesh_cache_header(*blob);
+        check(header.faces) == 3u;
+        check(header.face_offset % 64) == 0u;
+        auto const cached =
+                animray::view_mesh_cache<mesh_type>(*blob, blob);
+        check(reinterpret_cast<std::byte const *>(cached.vertices().data()))
+                == blob->data() + header.vertex_offset;
+        check(std::equal(
+                      original.vertices().begin(), original.vertices().end(),
+                      cached.vertices().begin(), cached.vertices().end()))
+                .is_truthy();
+        check(std::equal(
+                      original.faces().begin(), original.faces().end(),
+                      cached.faces().begin(), cached.faces().end()))
+                .is_truthy();
+        check(std::equal(
+                      original.normals().begin(), original.normals().end(),
+                      cached.normals().begin(), cached.normals().end()))
+                .is_truthy();
+        check(cached.nodes().size()) == original.nodes().size();
+        check(cached.bounds()) == original.bounds();
+
+        check([&]() {
+            animray::view_mesh_cache<animray::mesh<animray::ray<double>>>(
+                    *blob, blob);
+        }).throws(std::runtime_error{
+                "Mesh cache was written for a different value type"});
+        check([&]() {
+            animray::view_mesh_cache<mesh_type>(
+                    std::span{*blob}.first(size - 1), blob);
+        }).throws(felspar::overflow_error<std::size_t>{
+                "Mesh cache runs past the end of the file"});
+        check([&]() {
+            (*blob)[0] = std::byte{'X'};
+            animray::view_mesh_cache<mesh_type>(*blob, blob);
+        }).throws(std::runtime_error{"This is not a mesh cache"});
+    });
+
+
+    auto const qc = suite.test("quantised mesh cache", [](auto check) {
+        using q_type = animray::mesh<
+                animray::ray<float>, float,
+                animray::quantised_positions<float, 16>,
+                animray::octahedral_normals<float>>;
+        std::string text;
+        for (int v{}; v != 50; ++v) {
+            text += "v " + std::to_string(v) + " " + std::to_string(v % 7)
+                    + " " + std::to_string(v % 3) + "\n";
+            text += "vn 0 " + std::to_string(v % 2) + " 1\n";
+        }
+        for (int f{1}; f + 2 <= 50; ++f) {
+            auto const i = std::to_string(f), j = std::to_string(f + 1),
+                       k = std::to_string(f + 2);
+            text += "f " + i + "//" + i + " " + j + "//" + j + " " + k + "//"
+                    + k + "\n";
+        }
+        auto const original = animray::parse_obj<q_type>(text);
+        std::stringstream out;
+        auto const size = animray::write_mesh_cache(out, original);
+        auto const blob = std::make_shared<std::string>(out.str());
+        std::span<std::byte const> const bytes{
+                reinterpret_cast<std::byte const *>(blob->data()), size};
+        auto const cached = animray::view_mesh_cache<q_type>(bytes, blob);
+        check(cached.position_encoding().range())
+                == original.position_encoding().range();
+        for (std::size_t v{}; v != original.vertices().size(); ++v) {
+            check(cached.vertex(v)) == original.vertex(v);
+            check(cached.normal(v)) == original.normal(v);
+        }
+        check([&]() { animray::view_mesh_cache<mesh_type>(bytes, blob); })
+                .throws(std::runtime_error{
+                        "Mesh cache was written with a different encoding"});
+    });
+
+
+}
@@ -0,0 +1,139 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/geometry/heightfield.hpp>
+#include <animray/ray.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using point_type = animray::point3d<double>;
+    using heightfield_type = animray::heightfield<ray_type>;
+    using mesh_type = animray::mesh<ray_type>;
+
+
+    animray::film<float> bumps(std::size_t const w, std::size_t const h) {
+        return {w, h, [](auto const x, auto const y) {
+                    return float(std::sin(x * 0.7) * std::cos(y * 0.4) * 3
+                                 + (x * y % 5) * 0.25);
+                }};
+    }
+
+
+    /// The same terrain as a mesh with the cells split the same way
+    mesh_type triangulate(heightfield_type const &hf) {
+        std::vector<mesh_type::vertex_type> vertices;
+        std::vector<mesh_type::face_type> faces;
+        auto const w = std::uint32_t(hf.columns());
+        for (std::uint32_t y{}; y != hf.rows(); ++y) {
+            for (std::uint32_t x{}; x != w; ++x) {
+                vertices.push_back({double(x), double(y), hf.height(x, y)});
+                if (x and y) {
+                    auto const v = y * w + x;
+                    faces.push_back({v - w - 1, v - w, v});
+                    faces.push_back({v - w - 1, v, v - 1});
+                }
+            }
+        }
+        return {std::move(vertices), std::move(faces)};
+    }
+
+
+    auto const f = suite.test("flat", [](auto check) {
+        heightfield_type const hf{animray::film<float>{2, 2, 1.5f}};
+        check(hf.levels()) == 1u;
+        check(hf.bounds().upper[2]) == 1.5;
+        auto const hit = hf.intersects(
+                ray_type(
+                        point_type(0.3, 0.6, 4),
+                        animray::unit_vector<double>(0, 0, -1)),
+                1e-9);
+        check(hit.has_value()) == true;
+        animray::check_close(check, hit->from, point_type(0.3, 0.6, 1.5));
+        check(hit->direction) == animray::unit_vector<double>(0, 0, 1);
+        check(hf.occludes(
+                      ray_type(point_type(0.3, 0.6, 1), point_type(3, 3, 1)),
+                      1e-9))
+                .is_falsey();
+        check(hf.occludes(
+                      ray_type(point_type(-1, -1, 2), point_type(3, 3, 1)),
+                      1e-9))
+                .is_truthy();
+    });
+
+
+    auto const m = suite.test("matches mesh", [](auto check) {
+        for (auto const &[w, h] :
+             {std::pair<std::size_t, std::size_t>{37, 23},
+              {64, 64},
+              {2, 19},
+              {100, 3}}) {
+            heightfield_type const hf{bumps(w, h)};
+            auto const triangles = triangulate(hf);
+            check(hf.bounds()) == triangles.bounds();
+
+            std::size_t hits{}, wrong{};
+            for (double a{}; a < 6.3; a += 0.05) {
+                for (double z : {-5.0, 2.0, 6.0}) {
+                    point_type const from{
+                            w / 2.0 + std::cos(a) * w,
+                            h / 2.0 + std::sin(a) * h, z};
+                    point_type const to{
+                            w / 2.0 + std::sin(a * 3) * w / 3.0,
+                            h / 2.0 + std::cos(a * 5) * h / 3.0, 0.1};
+                    ray_type const r{from, to};
+                    auto const expected = triangles.intersects(r, 1e-9);
+                    auto const found = hf.intersects(r, 1e-9);
+                    if (found.has_value() != expected.has_value()
+                        or hf.occludes(r, 1e-9) != expected.has_value()) {
+                        ++wrong;
+                    } else if (found) {
+                        ++hits;
+                        animray::check_close(
+                                check, found->from, expected->from, 1e-6);
+                    }
+                }
+            }
+            check(wrong) == 0u;
+            check(hits) > 0u;
+        }
+    });
+
+
+    auto const e = suite.test("errors", [](auto check) {
+        check([]() {
+            heightfield_type{animray::film<float>{1, 5}};
+        }).throws(felspar::underflow_error<std::size_t>{
+                "A heightfield needs at least two columns", 1});
+        check([]() {
+            heightfield_type{animray::film<float>{5, 1}};
+        }).throws(felspar::underflow_error<std::size_t>{
+                "A heightfield needs at least two rows", 1});
+    });
+
+
+}
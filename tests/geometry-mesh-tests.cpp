@@ -0,0 +1,223 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/geometry/collection.hpp>
+#include <animray/geometry/mesh.hpp>
+#include <animray/geometry/planar/triangle.hpp>
+#include <animray/ray.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using mesh_type = animray::mesh<animray::ray<double>>;
+    using ray_type = animray::ray<double>;
+    using point_type = animray::point3d<double>;
+
+
+    auto const s = suite.test("single", [](auto check) {
+        mesh_type const m{{{0, 0, 0}, {5, 0, 0}, {0, 3, 0}}, {{0, 1, 2}}};
+        check(m.occludes(
+                      ray_type(
+                              point_type(1, 1, 1),
+                              animray::unit_vector<double>(0, 0, -1)),
+                      0))
+                .is_truthy();
+        check(m.intersects(
+                       ray_type(
+                               point_type(1, 1, 1),
+                               animray::unit_vector<double>(0, 0, -1)),
+                       0)
+                      .value()
+                      .direction)
+                == animray::unit_vector<double>(0, 0, 1);
+        check(m.intersects(
+                       ray_type(point_type(0, 0, -1), point_type(1, 1, 0)), 0)
+                      .value()
+                      .direction)
+                == animray::unit_vector<double>(0, 0, -1);
+        check(m.occludes(
+                      ray_type(
+                              point_type(-1, 1, -1),
+                              animray::unit_vector<double>(0, 0, -1)),
+                      0))
+                .is_falsey();
+        check(m.occludes(
+                      ray_type(
+                              point_type(5, 5, 1),
+                              animray::unit_vector<double>(0, 0, -1)),
+                      0))
+                .is_falsey();
+    });
+
+
+    auto const c = suite.test("cube matches triangles", [](auto check) {
+        std::vector<mesh_type::vertex_type> const corners{
+                {1, 1, 1},   {1, -1, 1},   {-1, -1, 1},  {-1, 1, 1},
+                {1, 1, -1},  {1, -1, -1},  {-1, -1, -1}, {-1, 1, -1}};
+        std::vector<mesh_type::face_type> const faces{
+                {0, 1, 2}, {2, 3, 0}, {4, 5, 6}, {6, 7, 4},
+                {0, 4, 1}, {1, 5, 4}, {1, 2, 6}, {6, 5, 1},
+                {2, 6, 3}, {3, 7, 6}, {3, 7, 0}, {0, 4, 7}};
+        mesh_type const cube{corners, faces};
+        check(cube.faces().size()) == faces.size();
+        check(cube.bounds().lower) == mesh_type::vertex_type{-1, -1, -1};
+        check(cube.bounds().upper) == mesh_type::vertex_type{1, 1, 1};
+
+        using triangle = animray::triangle<ray_type>;
+        animray::collection<triangle> triangles;
+        auto const corner = [&](auto const i) {
+            return point_type(corners[i][0], corners[i][1], corners[i][2]);
+        };
+        for (auto const &f : faces) {
+            triangles.insert(
+                    triangle{corner(f[0]), corner(f[1]), corner(f[2])});
+        }
+
+        for (int x{-6}; x <= 6; ++x) {
+            for (int y{-6}; y <= 6; ++y) {
+                ray_type const r{
+                        point_type(0.3, -0.2, -5),
+                        point_type(x / 4.0, y / 4.0, 0)};
+                auto const m = cube.intersects(r, 1e-9);
+                auto const t = triangles.intersects(r, 1e-9);
+                check(m.has_value()) == t.has_value();
+                check(cube.occludes(r, 1e-9)) == t.has_value();
+                if (m and t) {
+                    animray::check_close(check, m->from, t->from);
+                    check(m->direction) == t->direction;
+                }
+            }
+        }
+    });
+
+
+    auto const n = suite.test("smooth normals", [](auto check) {
+        mesh_type const m{
+                {{-1, -1, 0}, {1, -1, 0}, {0, 1, 0}},
+                {{0, 1, 2}},
+                {{-1, 0, -1}, {1, 0, -1}, {0, 1, -1}}};
+        auto const hit = m.intersects(
+                                  ray_type(
+                                          point_type(-0.5, -0.5, -1),
+                                          point_type(-0.5, -0.5, 0)),
+                                  0)
+                                 .value();
+        check(hit.direction.x()) < 0;
+        check(hit.direction.z()) < 0;
+        auto const centre = m.intersects(
+                                     ray_type(
+                                             point_type(0, -0.25, -1),
+                                             point_type(0, -0.25, 0)),
+                                     0)
+                                    .value();
+        animray::check_close(check, centre.direction.x(), 0.0);
+    });
+
+
+    auto const e = suite.test("bad indexes", [](auto check) {
+        check([]() {
+            mesh_type{{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}, {{0, 1, 3}}};
+        }).throws(felspar::overflow_error<std::size_t>{
+                "Mesh vertex index is out of range"});
+        check([]() {
+            mesh_type{
+                    {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}},
+                    {{0, 1, 2}},
+                    {{0, 0, 1}}};
+        }).throws(felspar::overflow_error<std::size_t>{
+                "There must be a normal for every vertex"});
+    });
+
+
+    auto const q = suite.test("quantised", [](auto check) {
+        using q16_type = animray::mesh<
+                ray_type, double, animray::quantised_positions<double, 16>,
+                animray::octahedral_normals<double>>;
+        using q21_type = animray::mesh<
+                ray_type, double, animray::quantised_positions<double, 21>>;
+        static_assert(sizeof(q16_type::stored_vertex_type) == 6);
+        static_assert(sizeof(q16_type::stored_normal_type) == 4);
+        static_assert(sizeof(q21_type::stored_vertex_type) == 8);
+
+        std::vector<mesh_type::vertex_type> vertices;
+        std::vector<mesh_type::normal_type> normals;
+        std::vector<mesh_type::face_type> faces;
+        for (std::uint32_t y{}; y != 20; ++y) {
+            for (std::uint32_t x{}; x != 20; ++x) {
+                vertices.push_back({x * 0.37, y * 0.21, (x * y) % 5 * 0.1});
+                normals.push_back({x - 10.0, y - 10.0, -4.0});
+                if (x and y) {
+                    auto const v = y * 20 + x;
+                    faces.push_back({v - 21, v - 20, v});
+                    faces.push_back({v - 21, v, v - 1});
+                }
+            }
+        }
+        mesh_type const exact{vertices, faces, normals};
+        q16_type const q16{vertices, faces, normals};
+        q21_type const q21{vertices, faces, normals};
+        check(q16.bounds()) == exact.bounds();
+        for (std::size_t v{}; v != vertices.size(); ++v) {
+            for (std::size_t a{}; a != 3; ++a) {
+                animray::check_close(
+                        check, q16.vertex(v)[a], vertices[v][a], 1e-4);
+                animray::check_close(
+                        check, q21.vertex(v)[a], vertices[v][a], 1e-5);
+            }
+            auto const n = q16.normal(v);
+            auto const length = std::sqrt(
+                    normals[v][0] * normals[v][0]
+                    + normals[v][1] * normals[v][1]
+                    + normals[v][2] * normals[v][2]);
+            auto const decoded =
+                    std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (std::size_t a{}; a != 3; ++a) {
+                animray::check_close(
+                        check, n[a] / decoded, normals[v][a] / length, 1e-3);
+            }
+        }
+
+        // Aim away from the edges, where rounding may decide between two
+        // triangles or the edge of the mesh
+        for (int x{}; x != 14; ++x) {
+            for (int y{}; y != 14; ++y) {
+                ray_type const r{
+                        point_type(3, 2, 5),
+                        point_type(x * 0.5 + 0.013, y * 0.28 + 0.017, 0)};
+                auto const e = exact.intersects(r, 1e-9);
+                auto const h16 = q16.intersects(r, 1e-9);
+                auto const h21 = q21.intersects(r, 1e-9);
+                check(h21.has_value()) == e.has_value();
+                if (e and h16 and h21) {
+                    animray::check_close(check, h16->from, e->from, 1e-3);
+                    animray::check_close(check, h21->from, e->from, 1e-4);
+                }
+            }
+        }
+    });
+
+
+}
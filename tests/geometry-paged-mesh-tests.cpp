@@ -0,0 +1,125 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/geometry/paged-mesh.hpp>
+#include <animray/ray.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using point_type = animray::point3d<double>;
+    using mesh_type = animray::mesh<ray_type>;
+    using paged_type = animray::paged_mesh<ray_type>;
+
+
+    /// A bumpy square grid of triangles
+    mesh_type grid(std::uint32_t const side) {
+        std::vector<mesh_type::vertex_type> vertices;
+        std::vector<mesh_type::face_type> faces;
+        for (std::uint32_t y{}; y != side; ++y) {
+            for (std::uint32_t x{}; x != side; ++x) {
+                vertices.push_back(
+                        {double(x), double(y), double((x * y) % 3)});
+                if (x and y) {
+                    auto const v = y * side + x;
+                    faces.push_back({v - side - 1, v - side, v});
+                    faces.push_back({v - side - 1, v, v - 1});
+                }
+            }
+        }
+        return {std::move(vertices), std::move(faces)};
+    }
+
+
+    auto bricks(char const *const name) {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+
+    auto const m = suite.test("matches mesh", [](auto check) {
+        auto const whole = grid(40);
+        auto const path = bricks("animray-paged-mesh-match.bricks");
+        animray::save_bricks(path, whole, 100);
+        paged_type const paged{path, 16 << 10};
+        check(paged.cache().bricks().size()) > 15u;
+        check(paged.bounds()) == whole.bounds();
+
+        for (int x{-2}; x <= 42; x += 3) {
+            for (int y{-2}; y <= 42; y += 3) {
+                ray_type const r{
+                        point_type(20, 20, 10), point_type(x, y, 0)};
+                auto const expected = whole.intersects(r, 1e-9);
+                auto const found = paged.intersects(r, 1e-9);
+                check(found.has_value()) == expected.has_value();
+                check(paged.occludes(r, 1e-9)) == expected.has_value();
+                if (expected and found) {
+                    animray::check_close(check, found->from, expected->from);
+                    check(found->direction) == expected->direction;
+                }
+            }
+        }
+        check(paged.cache().misses()) > paged.cache().bricks().size();
+        check(paged.cache().resident()) <= std::size_t(16 << 10);
+        std::filesystem::remove(path);
+    });
+
+
+    auto const t = suite.test("threads", [](auto check) {
+        auto const whole = grid(60);
+        auto const path = bricks("animray-paged-mesh-threads.bricks");
+        animray::save_bricks(path, whole, 64);
+        paged_type const paged{path, 32 << 10};
+
+        std::atomic<std::size_t> wrong{};
+        std::vector<std::thread> threads;
+        for (int thread{}; thread != 4; ++thread) {
+            threads.emplace_back([&, thread]() {
+                for (int x{thread}; x < 60; x += 4) {
+                    for (int y{}; y < 60; ++y) {
+                        ray_type const r{
+                                point_type(x * 0.5, 30, 10),
+                                point_type(x, y, 0)};
+                        auto const expected = whole.intersects(r, 1e-9);
+                        auto const found = paged.intersects(r, 1e-9);
+                        if (found.has_value() != expected.has_value()
+                            or (found and found->from != expected->from)) {
+                            ++wrong;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &th : threads) { th.join(); }
+        check(wrong.load()) == 0u;
+        check(paged.cache().resident()) <= std::size_t(32 << 10);
+        std::filesystem::remove(path);
+    });
+
+
+}
@@ -19,8 +19,12 @@
 
 
 #include <animray/functional/traits.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
 #include <animray/geometry/quadrics/sphere-unit-origin.hpp>
+#include <animray/maths/angles.hpp>
+#include <animray/movable.hpp>
 #include <animray/ray.hpp>
+#include <animray/test.hpp>
 #include <felspar/test.hpp>
 
 
@@ -63,4 +67,109 @@ namespace {
     });
 
 
+
+    static_assert(animray::Regular<animray::sphere<animray::ray<float>>>);
+    static_assert(animray::Regular<animray::sphere<animray::ray<double>>>);
+
+
+    auto const cr = suite.test("centre and radius", [](auto check) {
+        using ray = animray::ray<double>;
+        using end_type = ray::end_type;
+        animray::sphere<ray> const s{{2, 3, 4}, 2};
+        auto const hit =
+                s.intersects(ray(end_type(2, 3, 10), end_type(2, 3, 0)));
+        check(hit.has_value()) == true;
+        animray::check_close(check, hit->from, end_type(2, 3, 6));
+        check(hit->direction) == animray::unit_vector<double>(0, 0, 1);
+        check(s.occludes(ray(end_type(2, 5.5, 10), end_type(2, 5.5, 0))))
+                .is_falsey();
+        check(s.occludes(ray(end_type(2, 4.5, 10), end_type(2, 4.5, 0))))
+                .is_truthy();
+    });
+
+
+    auto const mv = suite.test("matches movable", [](auto check) {
+        using ray = animray::ray<double>;
+        using end_type = ray::end_type;
+        animray::sphere<ray> s;
+        animray::movable<animray::unit_sphere_at_origin<ray>> m;
+        auto const place = [](auto &g) {
+            g(animray::translate<double>(1, -2, 3))(
+                     animray::scale<double>(3, 3, 3))(
+                    animray::translate<double>(0.5, 0, 0))(
+                    animray::scale<double>(0.5, 0.5, 0.5));
+        };
+        place(s);
+        place(m);
+        animray::check_close(check, end_type(s.centre), end_type(2.5, -2, 3));
+        animray::check_close(check, s.radius, 1.5);
+        for (double x{-2}; x <= 5; x += 0.25) {
+            for (double y{-5}; y <= 1; y += 0.25) {
+                ray const r{end_type(x, y, -10), end_type(2.5, -2, 3)};
+                auto const expected = m.intersects(r, 1e-9);
+                auto const found = s.intersects(r, 1e-9);
+                check(found.has_value()) == expected.has_value();
+                check(s.occludes(r, 1e-9)) == m.occludes(r, 1e-9);
+                if (found and expected) {
+                    animray::check_close(check, found->from, expected->from);
+                }
+            }
+        }
+        std::invalid_argument const error{
+                "A sphere can only be translated and scaled by the same "
+                "amount along every axis"};
+        check([&]() { s(animray::scale<double>(1, 2, 1)); }).throws(error);
+        check([&]() { s(animray::rotate_z<double>(30_deg)); }).throws(error);
+    });
+
+
+    auto const mp = suite.test("mixed precision", [](auto check) {
+        using ray = animray::ray<double>;
+        using end_type = ray::end_type;
+        auto const compare = [&](auto const &mixed, auto const &full,
+                                 end_type const &from, double const step) {
+            std::size_t hits{};
+            double const extent = full.radius * 1.5;
+            for (double x{-extent}; x <= extent; x += step) {
+                for (double y{-extent}; y <= extent; y += step) {
+                    ray const r{
+                            from,
+                            end_type(
+                                    full.centre.x() + x, full.centre.y() + y,
+                                    full.centre.z())};
+                    auto const expected = full.intersects(r);
+                    auto const found = mixed.intersects(r);
+                    check(found.has_value()) == expected.has_value();
+                    check(mixed.occludes(r)) == full.occludes(r);
+                    if (found and expected) {
+                        ++hits;
+                        animray::check_close(
+                                check, found->from, expected->from);
+                    }
+                }
+            }
+            check(hits) > 0u;
+        };
+
+        animray::sphere<ray, float> const small{{0.5f, -1, 2}, 1.25f};
+        animray::sphere<ray> const small_full{{0.5, -1, 2}, 1.25};
+        compare(small, small_full, end_type(0.5, -1, -20), 0.0625);
+
+        /// A sphere that is big enough to act as a floor, seen from close by
+        animray::sphere<ray, float> const floor{{0, -200, 0}, 200};
+        animray::sphere<ray> const floor_full{{0, -200, 0}, 200};
+        compare(floor, floor_full, end_type(0, 1, -400), 20);
+
+        /// Rays that only just touch, or just miss, the edge of the sphere
+        animray::sphere<ray, float> const unit;
+        animray::sphere<ray> const unit_full;
+        for (double edge : {1 - 1e-7, 1 - 1e-12, 1.0, 1 + 1e-12, 1 + 1e-7}) {
+            ray const r{end_type(edge, 0, -10), end_type(edge, 0, 10)};
+            check(unit.intersects(r).has_value())
+                    == unit_full.intersects(r).has_value();
+            check(unit.occludes(r)) == unit_full.occludes(r);
+        }
+    });
+
+
 }
@@ -0,0 +1,124 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/compound.hpp>
+#include <animray/geometry/planar/plane.hpp>
+#include <animray/geometry/planar/triangle.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
+#include <animray/geometry/visibility.hpp>
+#include <animray/library/lights/block.hpp>
+#include <animray/light/positions.hpp>
+#include <animray/surface/matte.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using matte = animray::matte<float>;
+    using ball_type = animray::surface<animray::sphere<ray_type>, matte>;
+    using floor_type = animray::surface<animray::plane<ray_type>, matte>;
+    using geometry_type = animray::compound<ball_type, floor_type>;
+    geometry_type const ball_on_floor{
+            ball_type{animray::sphere<ray_type>{{0, 0, 2}, 1}, matte{}},
+            floor_type{animray::plane<ray_type>{}, matte{}}};
+    animray::point3d<double> const above{0.5, 0.5, 6};
+
+
+    auto const sm = suite.test("shadow map", [](auto check) {
+        animray::shadow_map<double> const map{ball_on_floor, above, 128};
+        std::size_t decided{}, points{};
+        for (int y{-40}; y != 40; ++y) {
+            for (int x{-40}; x != 40; ++x, ++points) {
+                animray::point3d<double> const floor{x * 0.1, y * 0.1, 0};
+                auto const o = map.occluded(floor);
+                if (o) {
+                    ++decided;
+                    ray_type const shadow{floor, above};
+                    check(*o) == ball_on_floor.occludes(shadow, 1e-9);
+                }
+            }
+        }
+        /// Only points near the edge of the shadow need tracing
+        check(decided) > points * 9 / 10;
+
+        /// The top of the ball is lit, underneath it isn't
+        check(map.occluded({0, 0, 3})) == false;
+        check(map.occluded({0, 0, 0})) == true;
+    });
+
+
+    auto const thin = suite.test("thin occluder", [](auto check) {
+        /// A sheet just above the floor has to cast a shadow, even though
+        /// it is much closer to the floor than a texel is wide
+        using sheet_type = animray::surface<animray::triangle<ray_type>, matte>;
+        animray::compound<sheet_type, floor_type> const sheet_on_floor{
+                sheet_type{
+                        animray::triangle<ray_type>{
+                                animray::point3d<double>{-2, -2, 0.05},
+                                animray::point3d<double>{2, -1, 0.05},
+                                animray::point3d<double>{-1, 2, 0.05}},
+                        matte{}},
+                floor_type{animray::plane<ray_type>{}, matte{}}};
+        animray::shadow_map<double> const map{sheet_on_floor, above, 128};
+        std::size_t decided{}, shadowed{}, points{};
+        for (int y{-40}; y != 40; ++y) {
+            for (int x{-40}; x != 40; ++x, ++points) {
+                animray::point3d<double> const floor{x * 0.1, y * 0.1, 0};
+                if (auto const o = map.occluded(floor); o) {
+                    ++decided;
+                    ray_type const shadow{floor, above};
+                    check(*o) == sheet_on_floor.occludes(shadow, 1e-9);
+                    if (*o) { ++shadowed; }
+                }
+            }
+        }
+        check(decided) > points * 3 / 4;
+        check(shadowed) > 0u;
+    });
+
+
+    auto const vc = suite.test("visibility cache", [](auto check) {
+        animray::visibility_cache const cached{
+                ball_on_floor, std::vector{above}, 64};
+        ray_type const to_light{animray::point3d<double>(0, 0, 0), above};
+        check(cached.occludes(to_light, 1e-9)) == true;
+        /// Rays that aren't towards a light are traced
+        ray_type const sideways{
+                animray::point3d<double>(0, 0, 0),
+                animray::point3d<double>(0, 1, 0)};
+        check(cached.occludes(sideways, 1e-9)) == false;
+        check(cached.intersects(to_light, 1e-9).has_value()) == true;
+    });
+
+
+    auto const lp = suite.test("light positions", [](auto check) {
+        auto const positions = animray::light_positions<double>(
+                animray::library::lights::narrow_block<double>);
+        check(positions.size()) == 3u;
+        check(positions[0]) == animray::point3d<double>{-3, 5, -5};
+    });
+
+
+}
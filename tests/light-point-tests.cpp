@@ -0,0 +1,117 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/color/rgb.hpp>
+#include <animray/compound.hpp>
+#include <animray/geometry/collection.hpp>
+#include <animray/geometry/planar/plane.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
+#include <animray/light/ambient.hpp>
+#include <animray/light/point.hpp>
+#include <animray/scene.hpp>
+#include <animray/surface/matte.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using ball_type = animray::surface<
+            animray::sphere<ray_type>, animray::matte<animray::rgb<float>>>;
+    using floor_type = animray::surface<
+            animray::plane<ray_type>, animray::matte<animray::rgb<float>>>;
+    using geometry_type =
+            animray::compound<animray::collection<ball_type>, floor_type>;
+
+    /// Three balls sitting on a floor
+    geometry_type balls() {
+        animray::matte<animray::rgb<float>> const grey{
+                animray::rgb<float>{0.5f}};
+        geometry_type g;
+        for (double const x : {-2.0, 0.0, 2.0}) {
+            std::get<0>(g.instances)
+                    .insert(ball_type{
+                            animray::sphere<ray_type>{{x, 0, 1}, 1}, grey});
+        }
+        std::get<1>(g.instances) =
+                floor_type{animray::plane<ray_type>{}, grey};
+        return g;
+    }
+
+
+    auto const ob = suite.test("occluder", [](auto check) {
+        auto const g = balls();
+        /// From under the middle ball straight up
+        ray_type const up{
+                animray::point3d<double>(0, 0, 0.5),
+                animray::point3d<double>(0, 0, 5)};
+        auto const found = g.occluder(up, 1e-6);
+        check(found.has_value()) == true;
+        /// The middle ball is the second of the three in the collection,
+        /// which is the first part of the compound
+        check(*found) == 2u;
+        check(g.occludes(up, 1e-6, *found)) == true;
+        /// The floor doesn't block it
+        check(g.occludes(up, 1e-6, 1)) == false;
+        /// The first ball doesn't either
+        check(g.occludes(up, 1e-6, 0)) == false;
+
+        ray_type const clear{
+                animray::point3d<double>(0, 5, 0.5),
+                animray::point3d<double>(0, 5, 5)};
+        check(g.occluder(clear, 1e-6).has_value()) == false;
+    });
+
+
+    auto const sh = suite.test("remembered shadows", [](auto check) {
+        using light_type =
+                animray::light<animray::point3d<double>, animray::rgb<float>>;
+        animray::scene<geometry_type, light_type, animray::rgb<float>> lit{
+                balls(),
+                light_type{{1, 2, 6}, animray::rgb<float>{100}},
+                animray::rgb<float>{}};
+        auto const render = [&]() {
+            std::vector<animray::rgb<float>> image;
+            for (int y{}; y != 20; ++y) {
+                for (int x{}; x != 40; ++x) {
+                    double const px = x * 0.2 - 4, py = y * 0.2 - 2;
+                    image.push_back(lit(ray_type{
+                            animray::point3d<double>(px, py, 5),
+                            animray::point3d<double>(px, py, 0)}));
+                }
+            }
+            return image;
+        };
+        auto const remembered = render();
+        lit.light.remember_occluder = false;
+        auto const forgotten = render();
+        check(remembered == forgotten) == true;
+        std::size_t const dark = std::count(
+                remembered.begin(), remembered.end(), animray::rgb<float>{});
+        check(dark) > 0u;
+        check(dark) < remembered.size();
+    });
+
+
+}
@@ -0,0 +1,97 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/color/rgb.hpp>
+#include <animray/light/ambient.hpp>
+#include <animray/light/sampled.hpp>
+#include <felspar/test.hpp>
+
+#include <array>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    auto const at = suite.test("alias table", [](auto check) {
+        std::array<double, 4> const weights{1, 0, 3, 4};
+        animray::alias_table const table{weights};
+        check(table.size()) == 4u;
+        check(table.probability(2)) == 3.0 / 8.0;
+
+        std::array<std::size_t, 4> counts{};
+        std::size_t const samples{8000};
+        for (std::size_t s{}; s != samples; ++s) {
+            auto const [i, p] = table.sample((s + 0.5) / samples);
+            check(p) == table.probability(i);
+            ++counts[i];
+        }
+        check(counts[0]) == 1000u;
+        check(counts[1]) == 0u;
+        check(counts[2]) == 3000u;
+        check(counts[3]) == 4000u;
+
+        animray::alias_table const none{std::array<double, 2>{}};
+        check(none.probability(1)) == 0.5;
+        check([]() {
+            animray::alias_table{std::array<double, 1>{-1}};
+        }).throws(std::invalid_argument{
+                "Alias table weights must not be negative"});
+    });
+
+
+    auto const sl = suite.test("sampled lights", [](auto check) {
+        /// Grey lights that shine the same everywhere are picked in
+        /// proportion to how much they contribute, so every sample gives
+        /// the total
+        using ambient = animray::light<void, animray::rgb<float>>;
+        animray::light<animray::sampled<ambient>, animray::rgb<float>> grey;
+        grey.push_back(ambient{animray::rgb<float>{10}});
+        grey.push_back(ambient{animray::rgb<float>{5}});
+        grey.push_back(ambient{animray::rgb<float>{}});
+        for (std::size_t sample{}; sample != 16; ++sample) {
+            animray::random::at_pixel(3, 4, sample);
+            check(std::abs(grey(0, 0, 0).red() - 15.0f)) < 1e-4f;
+        }
+
+        /// Coloured lights are only right on average
+        animray::light<animray::sampled<ambient, 2>, animray::rgb<float>> const
+                coloured{{ambient{animray::rgb<float>{10, 20, 30}},
+                          ambient{animray::rgb<float>{5, 0, 5}}}};
+        animray::rgb<float> total{};
+        std::size_t const samples{1024};
+        for (std::size_t sample{}; sample != samples; ++sample) {
+            animray::random::at_pixel(3, 4, sample);
+            total += coloured(0, 0, 0);
+        }
+        total /= samples;
+        check(std::abs(total.red() - 15.0f)) < 0.2f;
+        check(std::abs(total.green() - 20.0f)) < 0.4f;
+        check(std::abs(total.blue() - 35.0f)) < 0.2f;
+
+        animray::light<animray::sampled<ambient, 2>, animray::rgb<float>> const
+                none;
+        check(none(0, 0, 0)) == animray::rgb<float>{};
+    });
+
+
+}
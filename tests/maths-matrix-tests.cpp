@@ -34,6 +34,8 @@ namespace {
 
     static_assert(animray::Regular<animray::matrix<int>>);
     static_assert(animray::Regular<animray::matrix<float>>);
+    static_assert(animray::Regular<animray::affine_matrix<int>>);
+    static_assert(animray::Regular<animray::affine_matrix<float>>);
 
 
     auto const mm = suite.test("matrix multiply", [](auto check) {
@@ -105,4 +107,53 @@ namespace {
     });
 
 
+    auto const am = suite.test("affine matches matrix", [](auto check) {
+        auto const a = animray::rotate_x<double>(30_deg).first
+                * animray::translate<double>(1, -2, 3).forward()
+                * animray::scale<double>(2, 0.5, 3).first
+                * animray::rotate_z<double>(-70_deg).first;
+        animray::matrix<double> const m = a;
+        check(animray::affine_matrix<double>{m}) == a;
+
+        animray::point3d<double> const p(4, -1, 2, 2);
+        animray::check_close(check, a * p, m * p);
+        animray::check_close(
+                check,
+                animray::point3d<double>(
+                        a * animray::cartesian3d<double>{p}),
+                m * p);
+
+        animray::ray<double> const r(p, animray::point3d<double>(1, 1, 1));
+        auto const by_affine = r * a, by_matrix = r * m;
+        animray::check_close(check, by_affine.from, by_matrix.from);
+        animray::check_close(
+                check, animray::point3d<double>(by_affine.direction),
+                animray::point3d<double>(by_matrix.direction));
+    });
+
+
+    auto const an = suite.test("affine normal", [](auto check) {
+        // The normal of the plane x + y = 2 must stay perpendicular to it
+        // when it is squashed along the x axis
+        auto const squash = animray::scale<double>(0.5, 1, 1);
+        animray::ray<double> normal(
+                animray::point3d<double>(1, 1, 0),
+                animray::point3d<double>(2, 2, 0));
+        normal.transform_normal(squash.first, squash.second);
+        animray::check_close(
+                check, normal.from, animray::point3d<double>(0.5, 1, 0));
+        animray::check_close(
+                check, animray::point3d<double>(normal.direction),
+                animray::point3d<double>(
+                        2 / std::sqrt(5.0), 1 / std::sqrt(5.0), 0));
+
+        animray::matrix<double> projective;
+        projective[3][3] = 2;
+        check([&]() {
+            animray::affine_matrix<double>{projective};
+        }).throws(std::invalid_argument{
+                "The bottom row of an affine matrix must be 0 0 0 1"});
+    });
+
+
 }
@@ -0,0 +1,61 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <animray/maths/pow.hpp>
+#include <animray/surface/gloss.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    auto const wp = suite.test("whole power", [](auto check) {
+        check(animray::whole_pow(2, 0)) == 1;
+        check(animray::whole_pow(2, 1)) == 2;
+        check(animray::whole_pow(2, 10)) == 1024;
+        check(animray::whole_pow(3, 5)) == 243;
+        check(animray::whole_pow(0.5, 3)) == 0.125;
+        static_assert(animray::whole_pow(10, 3) == 1000);
+    });
+
+
+    auto const gh = suite.test("gloss highlight", [](auto check) {
+        /// Whole number widths match `std::pow` closely, whatever type the
+        /// width is given as
+        for (double const c : {0.1, 0.5, 0.9, 0.999}) {
+            double const expected = std::pow(c, 20);
+            check(std::abs(animray::gloss<double>{20}.highlight(c) - expected)
+                  <= expected * 1e-14)
+                    == true;
+            check(std::abs(
+                          animray::gloss<std::size_t>{20}.highlight(c)
+                          - expected)
+                  <= expected * 1e-14)
+                    == true;
+        }
+        /// Others go to `std::pow`
+        check(animray::gloss<double>{2.5}.highlight(0.25))
+                == std::pow(0.25, 2.5);
+    });
+
+
+}
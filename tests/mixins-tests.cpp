@@ -18,9 +18,14 @@
 */
 
 
+#include <animray/affine.hpp>
+#include <animray/geometry/planar/triangle.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
 #include <animray/ray.hpp>
 #include <animray/mixins/depth-count.hpp>
+#include <animray/mixins/setup.hpp>
 #include <animray/mixins/time.hpp>
+#include <animray/test.hpp>
 #include <felspar/test.hpp>
 
 
@@ -82,4 +87,48 @@ namespace {
     });
 
 
+    auto const setup = suite.test("setup", [](auto check) {
+        using ray_type = animray::ray<double>;
+        using set_up_type = animray::with_setup<ray_type>::type;
+        static_assert(not animray::is_set_up<ray_type>);
+        static_assert(animray::is_set_up<set_up_type>);
+        static_assert(std::is_same_v<
+                      animray::with_setup<set_up_type>::type, set_up_type>);
+
+        ray_type const plain{
+                animray::point3d<double>(2, 4, 6, 2),
+                animray::point3d<double>(1, 2, -1)};
+        auto const ray = animray::set_up(plain);
+        check(ray.from) == plain.from;
+        check(ray.cartesian_from) == animray::cartesian3d{1.0, 2.0, 3.0};
+        check(ray.cartesian_direction) == animray::direction3d(0.0, 0.0, -1.0);
+        check(ray.inverse[2]) == -1.0;
+        check(ray.from_dot_direction) == -3.0;
+        check(ray.from_dot_from) == 14.0;
+        check(&animray::set_up(ray)) == &ray;
+
+        auto const moved = ray * animray::translate<double>(0, 0, 1).forward();
+        static_assert(std::is_same_v<decltype(moved), ray_type const>);
+        check(animray::cartesian3d<double>{moved.from})
+                == animray::cartesian3d{1.0, 2.0, 4.0};
+
+        animray::triangle<ray_type> const triangle{
+                animray::point3d<double>(0, 0, 0),
+                animray::point3d<double>(4, 0, 0),
+                animray::point3d<double>(0, 4, 0)};
+        animray::unit_sphere_at_origin<ray_type> const unit;
+        animray::sphere<ray_type> const sphere{{1, 1, 1}, 2};
+        for (double x{-1}; x < 4; x += 0.5) {
+            ray_type const r{
+                    animray::point3d<double>(x, 1, 5),
+                    animray::point3d<double>(1, x, 0)};
+            auto const s = animray::set_up(r);
+            check(triangle.intersects(s, 1e-9)) == triangle.intersects(r, 1e-9);
+            check(unit.intersects(s)) == unit.intersects(r);
+            check(unit.occludes(s)) == unit.occludes(r);
+            check(sphere.intersects(s)) == sphere.intersects(r);
+        }
+    });
+
+
 }
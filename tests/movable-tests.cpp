@@ -0,0 +1,146 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/color/rgb.hpp>
+#include <animray/geometry/planar/triangle.hpp>
+#include <animray/geometry/quadrics/sphere.hpp>
+#include <animray/maths/angles.hpp>
+#include <animray/movable.hpp>
+#include <animray/surface.hpp>
+#include <animray/surface/matte.hpp>
+#include <animray/test.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    using ray_type = animray::ray<double>;
+    using point_type = animray::point3d<double>;
+    using unit_sphere = animray::unit_sphere_at_origin<ray_type>;
+    using matte = animray::matte<animray::rgb<float>>;
+
+
+    /// Check that two objects are struck by the same rays at the same
+    /// places
+    template<typename A, typename B>
+    void check_same(auto check, A const &a, B const &b) {
+        std::size_t hits{};
+        for (double x{-4}; x < 4; x += 0.25) {
+            for (double y{-4}; y < 4; y += 0.25) {
+                ray_type const r{point_type(x, y, 10), point_type(y, x, 0)};
+                auto const hit_a = a.intersects(r, 1e-9);
+                auto const hit_b = b.intersects(r, 1e-9);
+                check(hit_a.has_value()) == hit_b.has_value();
+                if (hit_a and hit_b) {
+                    ++hits;
+                    animray::check_close(check, hit_a->from, hit_b->from);
+                    animray::check_close(
+                            check, point_type(hit_a->direction),
+                            point_type(hit_b->direction));
+                }
+            }
+        }
+        check(hits) > 0u;
+    }
+
+
+    auto const f = suite.test("flatten", [](auto check) {
+        animray::movable<animray::movable<unit_sphere>> nested;
+        nested(animray::rotate_z<double>(30_deg))(
+                animray::translate<double>(1, 0, 0));
+        nested.instance(animray::scale<double>(2, 1, 1))(
+                animray::translate<double>(0, 0.5, 0));
+        auto const flat = animray::flatten(nested);
+        static_assert(std::is_same_v<
+                      decltype(flat), animray::movable<unit_sphere> const>);
+        check_same(check, nested, flat);
+
+        animray::movable<animray::surface<animray::movable<unit_sphere>, matte>>
+                shaded{animray::movable<unit_sphere>{}, matte{{1, 0, 0}}};
+        shaded(animray::translate<double>(0, 1, 0));
+        shaded.instance.geometry(animray::scale<double>(1, 3, 1));
+        auto const flat_shaded = animray::flatten(shaded);
+        static_assert(std::is_same_v<
+                      decltype(flat_shaded),
+                      animray::movable<
+                              animray::surface<unit_sphere, matte>> const>);
+        check_same(check, shaded, flat_shaded);
+
+        /// The intersection type of the outer `movable` is kept
+        using plain_intersection = unit_sphere::intersection_type;
+        animray::movable<
+                animray::surface<animray::movable<unit_sphere>, matte>,
+                plain_intersection>
+                sliced{animray::movable<unit_sphere>{}, matte{{0, 1, 0}}};
+        sliced(animray::rotate_y<double>(15_deg));
+        sliced.instance.geometry(animray::translate<double>(0.5, 0, 0));
+        auto const flat_sliced = animray::flatten(sliced);
+        static_assert(std::is_same_v<
+                      decltype(flat_sliced),
+                      animray::movable<
+                              animray::surface<unit_sphere, matte>,
+                              plain_intersection> const>);
+        check_same(check, sliced, flat_sliced);
+    });
+
+
+    auto const b = suite.test("bake", [](auto check) {
+        using triangle_type = animray::triangle<ray_type>;
+        animray::movable<triangle_type> triangle{
+                point_type(0, 0, 0), point_type(2, 0, 1), point_type(0, 3, 0)};
+        triangle(animray::rotate_x<double>(20_deg))(
+                animray::translate<double>(-1, -1, 0))(
+                animray::scale<double>(1, 1.5, 1));
+        triangle_type const baked_triangle = animray::bake(triangle);
+        check_same(check, triangle, baked_triangle);
+
+        animray::movable<unit_sphere> ball;
+        ball(animray::translate<double>(1, 1, 0))(
+                animray::rotate_y<double>(45_deg))(
+                animray::scale<double>(2, 2, 2));
+        animray::sphere<ray_type> const baked_ball = animray::bake(ball);
+        check_same(check, ball, baked_ball);
+
+        animray::movable<animray::surface<unit_sphere, matte>> red{
+                unit_sphere{}, matte{{1, 0, 0}}};
+        red(animray::translate<double>(0, -1, 0));
+        auto const baked_red = animray::bake(red);
+        static_assert(std::is_same_v<
+                      decltype(baked_red),
+                      animray::surface<
+                              animray::sphere<ray_type>, matte> const>);
+        check(baked_red.geometry.centre)
+                == animray::cartesian3d<double>{0, -1, 0};
+        check_same(check, red, baked_red);
+
+        ball(animray::scale<double>(1, 2, 1));
+        check([&]() {
+            animray::bake(ball);
+        }).throws(std::invalid_argument{
+                "A sphere can only be rotated, translated and scaled by the "
+                "same amount along every axis"});
+    });
+
+
+}
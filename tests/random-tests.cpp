@@ -0,0 +1,146 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/camera/flat-jitter.hpp>
+#include <animray/threading/sampler.hpp>
+#include <felspar/test.hpp>
+
+#include <set>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    /// Known answers from the Random123 distribution
+    static_assert(
+            animray::philox({0, 0, 0, 0}, {0, 0})
+            == std::array<std::uint32_t, 4>{
+                    0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    static_assert(
+            animray::philox(
+                    {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                    {0xa4093822, 0x299f31d0})
+            == std::array<std::uint32_t, 4>{
+                    0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+
+
+    auto const ui = suite.test("unit interval", [](auto check) {
+        check(animray::unit_interval<float>(0)) == 0.0f;
+        check(animray::unit_interval<float>(~std::uint32_t{})) < 1.0f;
+        check(animray::unit_interval<double>(~std::uint32_t{})) < 1.0;
+        check(animray::unit_interval<double>(0x80000000)) == 0.5;
+    });
+
+
+    auto const ce = suite.test("counter engine", [](auto check) {
+        animray::random::counter_engine e;
+        e.frame(3);
+        e.pixel(10, 20);
+        auto const first = e(), second = e();
+        check(first) != second;
+        check(e.location()) == animray::random::sample_location{3, 10, 20, 0};
+
+        /// Moving on to the next sample starts a new set of numbers
+        e.sample(1);
+        check(e.location()) == animray::random::sample_location{3, 10, 20, 1};
+        check(e()) != first;
+        /// Asking for the same pixel again starts it again
+        e.pixel(11, 20);
+        e.pixel(10, 20);
+        check(e()) == first;
+        check(e()) == second;
+        e.pixel(10, 20, 1);
+        check(e()) == animray::random::bits({3, 10, 20, 1}, 0);
+        /// Another frame gets different numbers
+        e.frame(4);
+        e.pixel(10, 20);
+        check(e.location()) == animray::random::sample_location{4, 10, 20, 0};
+        check(e()) != first;
+    });
+
+
+    auto const jb = suite.test("jitter is reproducible", [](auto check) {
+        animray::flat_jitter_camera<double> const camera{4.0, 2.0, 40, 20};
+        animray::random::at_frame(7);
+        animray::random::at_pixel(12, 11);
+        auto const sample0 = camera(12, 11);
+        animray::random::at_sample(1);
+        auto const sample1 = camera(12, 11);
+        check(sample0) != sample1;
+
+        /// The tile works the positions out slightly differently, so there
+        /// may be rounding differences
+        std::array<double, 6> xs, ys;
+        camera.positions(11, 10, 3, 2, xs, ys, 1);
+        check(std::abs(xs[4] - sample1.x)) < 1e-12;
+        check(std::abs(ys[4] - sample1.y)) < 1e-12;
+        camera.positions(11, 10, 3, 2, xs, ys);
+        check(std::abs(xs[4] - sample0.x)) < 1e-12;
+        check(std::abs(ys[4] - sample0.y)) < 1e-12;
+    });
+
+
+
+    /// Check that 16 samples of a pixel fall one in each sixteenth of both
+    /// axes, and one in each cell of a 4x4 grid
+    template<typename S>
+    void check_stratified(auto check) {
+        for (std::uint32_t x{}; x != 8; ++x) {
+            for (std::uint32_t pair{}; pair != 2; ++pair) {
+                std::set<int> across, down, cells;
+                for (std::uint32_t sample{}; sample != 16; ++sample) {
+                    animray::random::sample_location const l{2, x, 3, sample};
+                    double const u = S::value(l, 2 * pair);
+                    double const v = S::value(l, 2 * pair + 1);
+                    check(u) >= 0.0;
+                    check(u) < 1.0;
+                    across.insert(int(u * 16));
+                    down.insert(int(v * 16));
+                    cells.insert(int(u * 4) * 4 + int(v * 4));
+                }
+                check(across.size()) == 16u;
+                check(down.size()) == 16u;
+                check(cells.size()) == 16u;
+            }
+        }
+    }
+    auto const ld = suite.test("low discrepancy", [](auto check) {
+        check_stratified<animray::random::sobol>(check);
+        check_stratified<animray::random::cmj<16>>(check);
+
+        /// Halton is only stratified along the base 2 axis
+        std::set<int> halton;
+        for (std::uint32_t sample{}; sample != 16; ++sample) {
+            halton.insert(int(
+                    animray::random::halton::value({0, 1, 2, sample}, 0)
+                    * 16));
+        }
+        check(halton.size()) == 16u;
+
+        /// Different pixels get differently scrambled points
+        check(animray::random::sobol::value({0, 1, 2, 0}, 0))
+                != animray::random::sobol::value({0, 2, 2, 0}, 0);
+    });
+
+
+}
@@ -0,0 +1,89 @@
+/**
+    Copyright 2021, [Kirit Saelensminde](https://kirit.com/AnimRay).
+
+    This file is part of AnimRay.
+
+    AnimRay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    AnimRay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with AnimRay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <animray/color/rgb.hpp>
+#include <animray/sampling.hpp>
+#include <felspar/test.hpp>
+
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite(__FILE__);
+
+
+    auto const ad = suite.test("adaptive", [](auto check) {
+        animray::sample_budget const budget{4, 64, 0.5};
+
+        std::size_t taken{};
+        auto const flat = animray::integrate(budget, [&]() {
+            ++taken;
+            return animray::rgb<float>{10, 20, 30};
+        });
+        check(taken) == 4u;
+        check(flat) == animray::rgb<float>{10, 20, 30};
+
+        /// Samples that disagree a lot use the whole budget
+        taken = 0;
+        auto const noisy = animray::integrate(budget, [&]() {
+            return taken++ % 2 ? 0.0 : 100.0;
+        });
+        check(taken) == 64u;
+        check(noisy) == 50.0;
+
+        /// Samples that disagree a little stop once the error is small
+        taken = 0;
+        animray::integrate(budget, [&]() { return taken++ % 2 ? 9.0 : 11.0; });
+        check(taken) == 8u;
+
+        /// A single sample is always followed by a second
+        taken = 0;
+        animray::integrate(animray::sample_budget{1, 8, 0.5}, [&]() {
+            return double(++taken);
+        });
+        check(taken) == 2u;
+    });
+
+
+    auto const sl = suite.test("sample locations", [](auto check) {
+        /// Each sample draws its numbers for its own place in the pixel,
+        /// whatever the thread drew before
+        animray::random::at_frame(2);
+        animray::random::at_pixel(5, 6);
+        animray::random::counter::e();
+        std::vector<animray::random::sample_location> locations;
+        std::vector<std::uint32_t> firsts;
+        animray::integrate(animray::sample_budget{4, 4, 0.5}, [&]() {
+            locations.push_back(animray::random::counter::e.location());
+            firsts.push_back(animray::random::counter::e());
+            return 0.0;
+        });
+        check(locations.size()) == 4u;
+        for (std::uint32_t s{}; s != locations.size(); ++s) {
+            check(locations[s])
+                    == animray::random::sample_location{2, 5, 6, s};
+            check(firsts[s]) == animray::random::bits({2, 5, 6, s}, 0);
+        }
+    });
+
+
+}
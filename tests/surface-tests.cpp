@@ -19,8 +19,15 @@
 
 
 #include <animray/color/rgb.hpp>
+#include <animray/compound.hpp>
+#include <animray/geometry/collection.hpp>
+#include <animray/geometry/planar/plane.hpp>
 #include <animray/geometry/quadrics/sphere-unit-origin.hpp>
+#include <animray/light/ambient.hpp>
+#include <animray/scene.hpp>
 #include <animray/surface/matte.hpp>
+#include <animray/surface/reflective.hpp>
+#include <animray/surface/transparent.hpp>
 #include <animray/test.hpp>
 #include <felspar/test.hpp>
 
@@ -78,4 +85,135 @@ namespace {
     });
 
 
+    auto const lit = suite.test("lit layers", [](auto check) {
+        using plane_type = animray::plane<animray::ray<double>>;
+        using mirror_type =
+                animray::surface<plane_type, animray::reflective<float>>;
+        using glass_type = animray::surface<
+                plane_type, animray::transparent<float>,
+                animray::reflective<float>>;
+        using painted_type = animray::surface<
+                plane_type, animray::reflective<float>,
+                animray::matte<float>>;
+        check(animray::surface_is_lit<mirror_type::intersection_type>::value)
+                == false;
+        check(animray::surface_is_lit<glass_type::intersection_type>::value)
+                == false;
+        check(animray::surface_is_lit<painted_type::intersection_type>::value)
+                == true;
+
+        /// Compound geometry is lit if any part is, and each hit can be
+        /// checked for the part that was struck
+        using compound_type = animray::compound<mirror_type, painted_type>;
+        check(animray::surface_is_lit<compound_type::intersection_type>::value)
+                == true;
+        compound_type const planes{
+                mirror_type{
+                        plane_type{{0, 0, 0}, {0, 0, 1}},
+                        animray::reflective<float>{0.5f}},
+                painted_type{
+                        plane_type{{0, 0, 2}, {0, 0, 1}},
+                        animray::reflective<float>{0.5f},
+                        animray::matte<float>{0.5f}}};
+        auto const down = planes.intersects(
+                animray::ray<double>{
+                        animray::point3d<double>(0, 0, 1),
+                        animray::point3d<double>(0, 0, 0)},
+                1e-6);
+        check(down.has_value()) == true;
+        check(animray::is_lit(*down)) == false;
+        auto const up = planes.intersects(
+                animray::ray<double>{
+                        animray::point3d<double>(0, 0, 1),
+                        animray::point3d<double>(0, 0, 2)},
+                1e-6);
+        check(up.has_value()) == true;
+        check(animray::is_lit(*up)) == true;
+    });
+
+
+    /// Looking up the z axis from `z` at two planes at `z = 0` and `z = 2`
+    /// with the same surface
+    template<typename S>
+    float between(
+            S s,
+            double const z,
+            animray::path_termination const &termination = {}) {
+        using plane_type = animray::plane<animray::ray<double>>;
+        using surface_type = animray::surface<plane_type, S>;
+        animray::scene<
+                animray::collection<surface_type>, animray::light<void, float>,
+                float>
+                planes{{}, animray::light<void, float>{10.0f}, 100.0f};
+        planes.termination = termination;
+        planes.geometry.insert(surface_type{
+                plane_type{{0, 0, 0}, animray::unit_vector<double>{0, 0, 1}},
+                s});
+        planes.geometry.insert(surface_type{
+                plane_type{{0, 0, 2}, animray::unit_vector<double>{0, 0, 1}},
+                s});
+        return planes(animray::ray<double>{
+                animray::point3d<double>(0, 0, z),
+                animray::point3d<double>(0, 0, z + 1)});
+    }
+    auto const mirror = suite.test("reflective path", [](auto check) {
+        /// The ray bounces between the mirrors until it is too deep. The
+        /// depth goes 1, 3, 7 so there are three hits before the background
+        /// is seen
+        check(between(animray::reflective<float>{0.5f, 5}, 1))
+                == 10.0f + 5.0f + 2.5f + 12.5f;
+        check(between(animray::reflective<float>{0.5f, 0}, 1))
+                == 10.0f + 50.0f;
+    });
+    auto const glass = suite.test("transparent path", [](auto check) {
+        check(between(animray::transparent<float>{0.5f, 5}, -1))
+                == 10.0f + 5.0f + 25.0f;
+        /// Once too deep the background is seen without being dimmed
+        check(between(animray::transparent<float>{0.5f, 1}, -1))
+                == 10.0f + 5.0f + 50.0f;
+    });
+
+
+    auto const roulette = suite.test("path termination", [](auto check) {
+        animray::reflective<float> const mirror{0.5f, 1u << 20};
+        /// Without Russian roulette the ray bounces twenty times
+        check(between(mirror, 1, {100})) > 19.99f;
+
+        /// With it most paths end early, but the average is the same
+        double total{};
+        std::size_t const samples{4096};
+        for (std::size_t sample{}; sample != samples; ++sample) {
+            animray::random::at_pixel(0, 0, sample);
+            total += between(mirror, 1, {1});
+        }
+        check(total / samples) > 19.0;
+        check(total / samples) < 21.0;
+
+        /// The cut-off stops before the path carries less than a tenth
+        check(between(mirror, 1, {100, 0.1}))
+                == 10.0f + 5.0f + 2.5f + 1.25f;
+        check(animray::path_termination::for_exposure(255, 255))
+                < 0.5 / 255 / 12.0;
+    });
+    auto const ended = suite.test("roulette ends paths", [](auto check) {
+        /// With the default termination the first three bounces are
+        /// always followed, after which the path carries a sixteenth of
+        /// the light and mostly stops there
+        animray::reflective<float> const mirror{0.5f, 1u << 20};
+        std::size_t stopped{}, followed{};
+        for (std::size_t sample{}; sample != 256; ++sample) {
+            animray::random::at_pixel(1, 2, sample);
+            float const seen = between(mirror, 1);
+            if (seen == 10.0f + 5.0f + 2.5f + 1.25f) {
+                ++stopped;
+            } else {
+                check(seen) > 19.0f;
+                ++followed;
+            }
+        }
+        check(stopped) > 200u;
+        check(followed) > 0u;
+    });
+
+
 }